@@ -4,13 +4,38 @@
 #include <limits.h> // For INT_MAX, INT_MIN
 #include <math.h>   // For fabs, ceil
 #include <stdbool.h> // For bool type
+#include <pthread.h> // Parallel sensitivity probes
+#include <unistd.h>  // For sysconf (core count)
+#include <stdint.h>  // For uint64_t cache keys
+#include <sys/stat.h> // For mkdir (cache directory)
+#include <stdatomic.h> // Lock-free trace ring buffer
+#include <time.h>      // For nanosleep (trace writer back-off)
+#include <sys/mman.h>  // For mmap (release trace replay)
+#include <fcntl.h>     // For open
 
 // --- Constants ---
 #define MAX_TASKS 10
 #define MAX_JOBS 1000
 #define MAX_FILENAME_LEN 100
-#define MAX_RESPONSE_TIMES_PER_TASK (MAX_JOBS / 2)
 #define NO_TASK_FOUND -1 // Indicate no suitable Tmin found
+#define MAX_WHATIF_RUNS 8 // What-if parameter variants re-simulated per invocation
+#define DEFAULT_CHECKPOINTS_PER_RUN 32 // Used when --whatif is given without --checkpoint-interval
+#define MAX_SENSITIVITY_SETS 16
+#define MAX_PROBE_THREADS 64
+#define SENSITIVITY_FACTOR_TOLERANCE 0.001 // Bisection stops when the factor interval is this narrow
+#define MAX_FACTOR_DOUBLINGS 10 // Upper bound search if the analytic necessary bound still schedules
+#define RESULT_CACHE_VERSION 4 // Bump whenever simulation or analysis semantics change
+#define RESULT_CACHE_MAGIC "MLLF-RESULT-CACHE"
+#define MAX_PATH_LEN 512
+#define MAX_CORES 16 // Partitioned mode
+#define EVENT_LOG_SIZE 150 // Per-tick event text
+#define TRACE_RING_CAPACITY 4096 // Trace records in flight between simulation and writer thread (power of two)
+#define TRACE_WRITE_BUFFER_SIZE (256 * 1024) // Formatted trace bytes collected per fwrite
+#define TRACE_MAX_RECORD_TEXT 512 // Upper bound of one formatted record
+#define TRACE_READY_PREVIEW 4 // Ready queue entries per trace line (the line is cut after ~18 chars anyway)
+#define REPLAY_POOL_SIZE MAX_JOBS // Job slots for released-but-unfinished jobs plus the release lookahead
+#define MAX_FREQUENCY_LEVELS 8 // DVFS mode
+#define DEFAULT_STATIC_POWER 0.1 // Share of full-speed power that does not scale with frequency
 
 // --- Data Structures ---
 typedef struct {
@@ -24,10 +49,60 @@ typedef struct {
     int calculated_laxity; // Store calculated laxity for decisions
     int first_start_time;
     int last_start_time; int finish_time;
+    int partial_work; // DVFS: progress toward the next unit of work, in % of one full-speed tick
     enum { NOT_ARRIVED, READY, RUNNING, COMPLETED, MISSED } status;
     int response_time; int turnaround_time; int waiting_time;
 } Job;
 
+typedef enum { POLICY_MLLF, POLICY_LLF } SchedulingPolicy;
+
+// Scheduler configuration. Costs are in ticks and are charged to the simulated timeline.
+typedef struct {
+    SchedulingPolicy policy; // POLICY_LLF re-evaluates laxities every tick (quantum of 1)
+    int switch_cost;    // Every context switch between two jobs
+    int preempt_cost;   // Additionally, when the switch preempts an unfinished job
+    int reload_penalty; // When a previously preempted job resumes (cache refill)
+    bool precise_tmin;  // Project laxity of NOT_ARRIVED jobs for Tmin, recalculate quantum on arrivals
+    bool quiet_misses;  // Output only (not in the cache key): do not mirror deadline misses to the console
+    int frequency_levels[MAX_FREQUENCY_LEVELS]; // DVFS speeds in % of full speed, ascending, last = 100
+    int frequency_level_count; // 0 = DVFS off (always full speed)
+    double static_power; // Power model: P(f) = static + (1 - static) * f^3 of full-speed power; idle draws static
+} SimulationOptions;
+
+// One trace event, recorded by the simulation thread and formatted by the writer thread
+typedef enum { TRACE_TICK, TRACE_DEADLINE_MISS } TraceRecordType;
+typedef struct {
+    TraceRecordType type;
+    int time;
+    char event_log[EVENT_LOG_SIZE];
+    int running_job_id; int running_laxity; int running_quantum; // running_job_id -1 = idle
+    int ready_count; // Full ready queue size; only the first TRACE_READY_PREVIEW entries are kept
+    int ready_job_ids[TRACE_READY_PREVIEW]; int ready_laxities[TRACE_READY_PREVIEW];
+    int job_id; int deadline; // TRACE_DEADLINE_MISS
+} TraceRecord;
+
+// Single-producer/single-consumer ring buffer feeding a writer thread. The producer waits when the
+// ring is full (back-pressure); the writer batches formatted records into large fwrite calls.
+typedef struct {
+    TraceRecord* records;
+    atomic_size_t head; // Next slot the producer fills
+    atomic_size_t tail; // Next slot the writer consumes
+    atomic_bool closed;
+    FILE* outfile;
+    bool console_misses;
+    bool threaded; // false if the writer thread could not be started: records are written inline
+    pthread_t thread;
+    char* buffer; size_t buffer_used;
+} TraceWriter;
+
+// Results accumulated during a simulation
+typedef struct {
+    int context_switches; int deadline_misses; int completed_jobs; int idle_time;
+    int preemptions; int reload_events; int overhead_time;
+    int quantum_expirations; int resetq_events;
+    int level_ticks[MAX_FREQUENCY_LEVELS]; // DVFS: busy ticks at each frequency level
+} SimulationCounters;
+
 // Simulation state (dynamic parts) - passed to simulation steps
 typedef struct {
     Job* ready_queue[MAX_JOBS];
@@ -38,17 +113,145 @@ typedef struct {
     // ---- MLLF Specific ----
     int current_job_quantum_remaining; // How much longer the current job can run uninterrupted
     // -----------------------
-    // Pointers to overall results updated during simulation
-    int* context_switches_ptr;
-    int* deadline_misses_ptr;
-    int* completed_jobs_ptr;
-    int* idle_time_ptr;
+    int overhead_remaining; // Switch/preemption/reload ticks still to be paid before the running job progresses
+    bool arrival_this_tick; // Set by step 1 of each tick
+    TraceWriter* trace; // NULL = no trace (silent run)
+    // ---- DVFS ----
+    int speed_level; // Index into options->frequency_levels
+    double task_share[MAX_TASKS]; // Cycle-conserving demand: WCET share at release, actual share after completion
+    const SimulationOptions* options;
+    // Overall results updated during simulation
+    SimulationCounters* counters;
 } SimulationState;
 
+// Snapshot of the simulation at the start of a tick (before arrivals are handled)
+typedef struct {
+    int time;
+    int ready_queue_idx[MAX_JOBS]; // Indices into jobs_arr (pointers do not survive a restore)
+    int ready_queue_size;
+    int running_job_idx; // -1 if CPU idle
+    int last_running_job_id;
+    int current_job_quantum_remaining;
+    int overhead_remaining;
+    int speed_level; double task_share[MAX_TASKS];
+    SimulationCounters counters;
+    Job* jobs; // Copy of jobs_arr at this time
+} SimulationCheckpoint;
+
+// Checkpoints taken every 'interval' ticks during a run, used to resume what-if runs
+typedef struct {
+    SimulationCheckpoint* entries;
+    int count; int capacity;
+    int interval;
+    int job_count;
+} CheckpointStore;
+
+typedef enum { FIT_FIRST, FIT_BEST, FIT_WORST } FitHeuristic; // Applied to tasks in decreasing utilization order
+
+// Command line: three positional filenames followed by optional flags
+typedef struct {
+    char task_filename[MAX_FILENAME_LEN];
+    char aet_filename[MAX_FILENAME_LEN];
+    char output_filename[MAX_FILENAME_LEN];
+    int positional_count;
+    int checkpoint_interval; // 0 = choose automatically when what-if runs are requested
+    int whatif_count;
+    char whatif_task_filenames[MAX_WHATIF_RUNS][MAX_FILENAME_LEN];
+    char whatif_aet_filenames[MAX_WHATIF_RUNS][MAX_FILENAME_LEN];
+    // ---- Sensitivity mode: llf_analyzer --sensitivity <output> <task file>... ----
+    bool sensitivity_mode;
+    int sensitivity_set_count;
+    char sensitivity_set_filenames[MAX_SENSITIVITY_SETS][MAX_FILENAME_LEN];
+    int thread_count; // 0 = one per online core
+    char cache_dir[MAX_FILENAME_LEN]; // Empty = result cache disabled
+    SimulationOptions sim;
+    // ---- Partitioned multicore mode ----
+    int partition_cores; // 0 = single core
+    FitHeuristic fit;
+    bool replay_mode; // Second positional file is a release trace instead of an AET file
+} CliOptions;
+
+// Task-to-core assignment produced by partition_tasks
+typedef struct {
+    int core_count;
+    int core_of_task[MAX_TASKS];
+    double core_density[MAX_CORES];
+    int core_task_count[MAX_CORES];
+} TaskPartition;
+
+// One core's share of the job set, simulated on its own thread
+typedef struct {
+    int core;
+    Job* jobs; int job_count;
+    int* global_index; // Position of each job in the full job array
+    int hyperperiod;
+    const SimulationOptions* options;
+    SimulationCounters counters;
+    FILE* trace; // Temporary file, merged into the output after all cores finish
+} CoreSimulation;
+
+// Memory-mapped release trace: whitespace separated "task_id release_time aet" triples, releases in time order
+typedef struct {
+    const char* data; size_t size;
+    size_t offset; int line;
+    int last_release;
+} ReleaseTrace;
+
+typedef struct { int task_id; int release_time; int aet; } ReleaseRecord;
+
+// Fixed job slots reused as jobs retire. Free slots are marked COMPLETED so the engine skips them;
+// high_water bounds the slots the engine scans.
+typedef struct {
+    Job* slots; bool* in_use;
+    int high_water; int live; int peak_live;
+} JobPool;
+
+// Per-task response time statistics, accumulated job by job
+typedef struct {
+    int samples; long long sum_rt; int min_rt; int max_rt; // sum_rt grows with run length (replay)
+    int max_rel_jitter; int last_rt;
+} TaskResponseStats;
+
+// Everything analyze_schedule_results reports except the per-job table (what the result cache stores)
+typedef struct {
+    int hyperperiod; int job_count; int task_count;
+    SchedulingPolicy policy; bool precise_tmin;
+    int level_count; // DVFS levels covered by counters.level_ticks
+    SimulationCounters counters;
+    int jobs_for_avg;
+    double total_turnaround; double total_waiting; double total_response;
+    TaskResponseStats task_stats[MAX_TASKS];
+} ScheduleSummary;
+
+// On-disk result cache: one file per canonical hash of the simulation inputs
+typedef struct {
+    bool enabled;
+    char dir[MAX_FILENAME_LEN];
+    int lookups; int hits; // This process
+} ResultCache;
+
+// One schedulability probe: the template job set simulated with the given per-task WCETs (AET = WCET)
+typedef struct {
+    const Job* template_jobs; int job_count; int hyperperiod;
+    const SimulationOptions* options;
+    int wcet_per_task[MAX_TASKS];
+    bool schedulable; // Result
+} SensitivityProbe;
+
+// Probes handled by one worker thread: first, first + stride, ...
+typedef struct {
+    SensitivityProbe* probes; int probe_count;
+    int first; int stride;
+} ProbeWorker;
+
 // --- Function Prototypes ---
 long long gcd(long long a, long long b);
 long long lcm(long long a, long long b);
 
+// Command line handling
+int parse_cli_options(int argc, char *argv[], CliOptions* cli);
+int resolve_thread_count(int requested);
+
 // Core functionality functions
 int read_tasks(const char* filename, Task tasks_arr[], int* task_count);
 long long calculate_hyperperiod(const Task tasks_arr[], int task_count);
@@ -56,16 +259,31 @@ int generate_jobs(long long hyperperiod, const Task tasks_arr[], int task_count,
 int read_actual_execution_times(const char* filename, Job jobs_arr[], int job_count);
 // *** Changed function name ***
 void run_mllf_simulation(int hyperperiod, Job jobs_arr[], int job_count, FILE* outfile,
-                         int* context_switches, int* deadline_misses, int* completed_jobs, int* idle_time);
+                         const SimulationOptions* options, SimulationCounters* counters, CheckpointStore* checkpoints);
+int resume_mllf_simulation(int hyperperiod, Job jobs_arr[], int job_count, FILE* outfile,
+                           const SimulationOptions* options, SimulationCounters* counters,
+                           const CheckpointStore* checkpoints, int divergence_time);
+int load_job_set(const char* task_filename, const char* aet_filename, Task tasks_arr[], int* task_count,
+                 Job jobs_arr[], int* job_count, int* hyperperiod);
 void analyze_schedule_results(const Job jobs_arr[], int job_count, const Task tasks_arr[], int task_count,
-                              int context_switches, int deadline_misses, int completed_jobs, int idle_time,
-                              int hyperperiod, FILE* outfile);
+                              const SimulationOptions* options, const SimulationCounters* counters,
+                              int hyperperiod, FILE* outfile, ScheduleSummary* summary);
+void init_schedule_summary(ScheduleSummary* summary, int job_count, int task_count,
+                           const SimulationOptions* options, const SimulationCounters* counters, int hyperperiod);
+bool completed_job_times(const Job* job, int* turnaround, int* waiting, int* response);
+void summarize_schedule(const Job jobs_arr[], int job_count, int task_count, const SimulationOptions* options,
+                        const SimulationCounters* counters, int hyperperiod, ScheduleSummary* summary);
+const char* policy_name(SchedulingPolicy policy);
+void accumulate_job_statistics(ScheduleSummary* summary, int task_id, int turnaround, int waiting, int response);
+void print_summary_counters(const ScheduleSummary* summary, FILE* outfile);
+void print_summary_statistics(const ScheduleSummary* summary, FILE* outfile);
 
 // Internal simulation helpers
 void add_job_to_ready_queue(SimulationState* state, Job* job);
 void remove_job_from_ready_queue(SimulationState* state, Job* job);
 // *** Changed function name and logic ***
 Job* select_mllf_task_Ta(SimulationState* state);
+bool job_precedes(const Job* a, const Job* b);
 // *** New helper functions ***
 int find_earliest_deadline_higher_laxity_job_deadline(SimulationState* state, Job* task_Ta, Job jobs_arr[], int job_count);
 int calculate_mllf_quantum(SimulationState* state, Job* task_Ta, Job jobs_arr[], int job_count);
@@ -76,14 +294,95 @@ void handle_completion(SimulationState* state);
 // *** Changed function name and logic ***
 void make_mllf_scheduling_decision(SimulationState* state, Job* candidate_Ta, char* event_log, size_t log_size, Job jobs_arr[], int job_count);
 void execute_running_job(SimulationState* state);
-void check_deadline_misses(SimulationState* state, Job jobs_arr[], int job_count, FILE* outfile);
+void check_deadline_misses(SimulationState* state, Job jobs_arr[], int job_count);
+void init_simulation_state(SimulationState* state, const SimulationOptions* options, SimulationCounters* counters);
+void charge_dispatch_overhead(SimulationState* state, bool context_switch, bool preemption, char* event_log, size_t log_size);
+void simulate_mllf_tick(SimulationState* state, Job jobs_arr[], int job_count);
+void advance_mllf_simulation(SimulationState* state, int end_time, Job jobs_arr[], int job_count, CheckpointStore* checkpoints);
+void trace_deadline_miss(SimulationState* state, const Job* job, int time);
+
+// DVFS slack reclamation
+void dvfs_note_release(SimulationState* state, const Job* job);
+void dvfs_note_completion(SimulationState* state, const Job* job);
+int dvfs_work_left(const Job* job);
+int dvfs_min_slack(const SimulationState* state, const Job jobs_arr[], int job_count);
+void select_dvfs_speed(SimulationState* state, const Job jobs_arr[], int job_count, char* event_log, size_t log_size);
+double power_at_speed(const SimulationOptions* options, int speed_percent);
+void report_dvfs_energy(int hyperperiod, const SimulationOptions* options, const SimulationCounters* full_speed,
+                        const SimulationCounters* scaled, FILE* outfile);
+int parse_frequency_levels(const char* list, SimulationOptions* options);
+
+// Asynchronous trace writer
+bool trace_writer_start(TraceWriter* writer, FILE* outfile, bool console_misses);
+TraceRecord* trace_writer_claim(TraceWriter* writer);
+void trace_writer_publish(TraceWriter* writer);
+void trace_writer_stop(TraceWriter* writer);
+void* trace_writer_main(void* arg);
+void trace_writer_consume(TraceWriter* writer, const TraceRecord* record);
+void trace_writer_flush(TraceWriter* writer);
+int format_trace_record(const TraceRecord* record, char* out, size_t size);
+
+// Checkpointing for incremental re-simulation
+void save_checkpoint(CheckpointStore* store, const SimulationState* state, const Job jobs_arr[], int job_count);
+const SimulationCheckpoint* find_checkpoint_at_or_before(const CheckpointStore* store, int time);
+void restore_checkpoint(SimulationState* state, const SimulationCheckpoint* checkpoint, Job jobs_arr[], int job_count);
+void free_checkpoints(CheckpointStore* store);
+int find_divergence_time(const Job old_jobs[], int old_count, const Job new_jobs[], int new_count, const SimulationOptions* options);
+void run_whatif_simulation(const CliOptions* cli, int whatif_index, const Job base_jobs[], int base_job_count,
+                           int base_hyperperiod, const CheckpointStore* checkpoints, ResultCache* cache, FILE* outfile);
+
+// Persistent result cache
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t len);
+uint64_t hash_int(uint64_t hash, int value);
+uint64_t compute_result_cache_key(const Task tasks_arr[], int task_count, const Job jobs_arr[], int job_count, int hyperperiod,
+                                  const SimulationOptions* options);
+void result_cache_open(ResultCache* cache, const char* dir);
+void result_cache_entry_path(const ResultCache* cache, uint64_t key, char* path, size_t path_size);
+bool result_cache_lookup(ResultCache* cache, uint64_t key, ScheduleSummary* summary);
+void result_cache_store(const ResultCache* cache, uint64_t key, const ScheduleSummary* summary);
+void result_cache_report(const ResultCache* cache, FILE* outfile);
+void print_cached_schedule_results(const ScheduleSummary* summary, uint64_t key, FILE* outfile);
+bool run_baseline_simulation(const Task tasks_arr[], int task_count, const Job pristine_jobs[], int job_count, int hyperperiod,
+                             const SimulationOptions* options, ResultCache* cache, SimulationCounters* counters);
+void report_mode_comparisons(const Task tasks_arr[], int task_count, const Job pristine_jobs[], int job_count, int hyperperiod,
+                             const SimulationOptions* options, ResultCache* cache, const SimulationCounters* counters, FILE* outfile);
+
+// Precise Tmin mode
+void report_tmin_mode_comparison(const SimulationCounters* simplified, const SimulationCounters* precise, FILE* outfile);
+
+// Breakdown utilization / WCET sensitivity
+int scaled_wcet(int wcet, double factor);
+double scaled_density(const Task tasks_arr[], int task_count, double factor);
+double find_density_factor(const Task tasks_arr[], int task_count, double unrounded_bound);
+void probe_schedulable(SensitivityProbe* probe);
+void* probe_worker_main(void* arg);
+void run_probe_batch(SensitivityProbe probes[], int probe_count, int thread_count);
+double find_breakdown_factor(const Task tasks_arr[], int task_count, const Job template_jobs[], int job_count, int hyperperiod,
+                             const SimulationOptions* options, int thread_count,
+                             double* sufficient_bound, double* necessary_bound, int* probes_run);
+int find_max_task_wcet(const Task tasks_arr[], int task_count, int task_index, const Job template_jobs[], int job_count,
+                       int hyperperiod, const SimulationOptions* options, int thread_count, int* probes_run);
+int run_sensitivity_analysis(const CliOptions* cli);
+
+// Trace-driven replay
+int open_release_trace(const char* filename, ReleaseTrace* trace);
+int next_release_record(ReleaseTrace* trace, ReleaseRecord* record);
+void close_release_trace(ReleaseTrace* trace);
+Job* job_pool_admit(JobPool* pool);
+void job_pool_retire_finished(JobPool* pool, ScheduleSummary* summary);
+int run_replay_simulation(const CliOptions* cli);
+
+// Partitioned multicore mode
+double task_density(const Task* task);
+int partition_tasks(const Task tasks_arr[], int task_count, int core_count, FitHeuristic fit, TaskPartition* partition);
+void* core_simulation_main(void* arg);
+int run_partitioned_simulation(const CliOptions* cli, const Task tasks_arr[], int task_count, Job jobs_arr[], int job_count,
+                               int hyperperiod, FILE* outfile);
 
 
 // --- Main Function ---
 int main(int argc, char *argv[]) {
-    char task_filename[MAX_FILENAME_LEN];
-    char aet_filename[MAX_FILENAME_LEN];
-    char output_filename[MAX_FILENAME_LEN];
+    CliOptions cli;
 
     // Static allocation for simplicity, ensure MAX_TASKS/MAX_JOBS are sufficient
     Task tasks_list[MAX_TASKS];
@@ -91,60 +390,213 @@ int main(int argc, char *argv[]) {
     int task_count = 0;
     int job_count = 0;
 
-    // --- Get Filenames ---
-    if (argc == 4) { /* Handle command line args */ /* ... */
-        strncpy(task_filename, argv[1], MAX_FILENAME_LEN - 1); task_filename[MAX_FILENAME_LEN - 1] = '\0';
-        strncpy(aet_filename, argv[2], MAX_FILENAME_LEN - 1); aet_filename[MAX_FILENAME_LEN - 1] = '\0';
-        strncpy(output_filename, argv[3], MAX_FILENAME_LEN - 1); output_filename[MAX_FILENAME_LEN - 1] = '\0';
-    } else { /* Prompt for filenames */ /* ... */
-        printf("Enter task set filename: "); if (!fgets(task_filename, sizeof(task_filename), stdin)) return 1; task_filename[strcspn(task_filename, "\n")] = 0;
-        printf("Enter AET filename: "); if (!fgets(aet_filename, sizeof(aet_filename), stdin)) return 1; aet_filename[strcspn(aet_filename, "\n")] = 0;
-        printf("Enter output filename: "); if (!fgets(output_filename, sizeof(output_filename), stdin)) return 1; output_filename[strcspn(output_filename, "\n")] = 0;
+    // --- Get Filenames & Options ---
+    if (!parse_cli_options(argc, argv, &cli)) return 1;
+    if (cli.sensitivity_mode) return run_sensitivity_analysis(&cli);
+    if (cli.replay_mode) return run_replay_simulation(&cli);
+    if (cli.positional_count < 3) { /* Prompt for filenames */ /* ... */
+        printf("Enter task set filename: "); if (!fgets(cli.task_filename, sizeof(cli.task_filename), stdin)) return 1; cli.task_filename[strcspn(cli.task_filename, "\n")] = 0;
+        printf("Enter AET filename: "); if (!fgets(cli.aet_filename, sizeof(cli.aet_filename), stdin)) return 1; cli.aet_filename[strcspn(cli.aet_filename, "\n")] = 0;
+        printf("Enter output filename: "); if (!fgets(cli.output_filename, sizeof(cli.output_filename), stdin)) return 1; cli.output_filename[strcspn(cli.output_filename, "\n")] = 0;
     }
 
     // --- Setup ---
-    if (!read_tasks(task_filename, tasks_list, &task_count)) return 1;
-    if (task_count == 0) { printf("No tasks loaded.\n"); return 0; }
+    int hyperperiod = 0;
+    int loaded = load_job_set(cli.task_filename, cli.aet_filename, tasks_list, &task_count, jobs_list, &job_count, &hyperperiod);
+    if (loaded <= 0) return loaded < 0 ? 0 : 1; // -1: nothing to simulate, 0: error
 
-    long long hyperperiod_ll = calculate_hyperperiod(tasks_list, task_count);
-    if (hyperperiod_ll <= 0 || hyperperiod_ll == -2) { fprintf(stderr, "Error: Invalid or excessive hyperperiod (%lld).\n", hyperperiod_ll); return 1; }
-    if (hyperperiod_ll > INT_MAX) { fprintf(stderr, "Error: Hyperperiod exceeds INT_MAX.\n"); return 1; }
-    int hyperperiod = (int)hyperperiod_ll;
+    // --- Open Output File ---
+    FILE *outfile = fopen(cli.output_filename, "w");
+    if (!outfile) { perror("Error opening output file"); return 1; }
+    printf("Output will be written to %s\n", cli.output_filename);
 
-    if (!generate_jobs(hyperperiod, tasks_list, task_count, jobs_list, &job_count)) return 1;
-    if (job_count == 0) { printf("No jobs generated within hyperperiod.\n"); return 0; }
+    if (cli.partition_cores > 0) {
+        int status = run_partitioned_simulation(&cli, tasks_list, task_count, jobs_list, job_count, hyperperiod, outfile);
+        fclose(outfile);
+        if (status == 0) printf("Simulation finished. Results saved to %s\n", cli.output_filename);
+        return status;
+    }
 
-     // Initialize calculated_laxity
-    for (int i = 0; i < job_count; ++i) {
-        jobs_list[i].calculated_laxity = INT_MAX; // Initialize
+    // --- Run Simulation & Analysis ---
+    SimulationCounters counters;
+
+    // Checkpoints are only needed if what-if variants will be resumed from this run
+    CheckpointStore checkpoints = {0};
+    if (cli.whatif_count > 0) {
+        checkpoints.interval = cli.checkpoint_interval > 0 ? cli.checkpoint_interval : hyperperiod / DEFAULT_CHECKPOINTS_PER_RUN;
+        if (checkpoints.interval < 1) checkpoints.interval = 1;
     }
 
-    if (!read_actual_execution_times(aet_filename, jobs_list, job_count)) return 1;
+    // Result cache: a hit skips simulation. What-if runs need the base run's checkpoints, so it always simulates then.
+    ResultCache cache = {0};
+    if (cli.cache_dir[0] != '\0') result_cache_open(&cache, cli.cache_dir);
+    uint64_t cache_key = compute_result_cache_key(tasks_list, task_count, jobs_list, job_count, hyperperiod, &cli.sim);
+    ScheduleSummary summary;
 
-    // --- Open Output File ---
-    FILE *outfile = fopen(output_filename, "w");
-    if (!outfile) { perror("Error opening output file"); return 1; }
-    printf("Output will be written to %s\n", output_filename);
+    if (cache.enabled && cli.whatif_count == 0 && result_cache_lookup(&cache, cache_key, &summary)) {
+        print_cached_schedule_results(&summary, cache_key, outfile);
+        // jobs_list was never simulated, so it is the pristine job set
+        report_mode_comparisons(tasks_list, task_count, jobs_list, job_count, hyperperiod, &cli.sim, &cache, &summary.counters, outfile);
+    } else {
+        // Precise Tmin and DVFS modes are compared against silent runs without them on the same jobs
+        Job* pristine_jobs = NULL;
+        if ((cli.sim.precise_tmin || cli.sim.frequency_level_count > 0) && (pristine_jobs = malloc(job_count * sizeof(Job))) != NULL) {
+            memcpy(pristine_jobs, jobs_list, job_count * sizeof(Job));
+        }
 
-    // --- Run Simulation & Analysis ---
-    int context_switches = 0, deadline_misses = 0, completed_jobs = 0, idle_time = 0;
+        // *** Call MLLF simulation ***
+        run_mllf_simulation(hyperperiod, jobs_list, job_count, outfile, &cli.sim, &counters,
+                            cli.whatif_count > 0 ? &checkpoints : NULL);
 
-    // *** Call MLLF simulation ***
-    run_mllf_simulation(hyperperiod, jobs_list, job_count, outfile,
-                        &context_switches, &deadline_misses, &completed_jobs, &idle_time);
+        analyze_schedule_results(jobs_list, job_count, tasks_list, task_count, &cli.sim, &counters,
+                                 hyperperiod, outfile, &summary);
+        if (cache.enabled) result_cache_store(&cache, cache_key, &summary);
 
-    analyze_schedule_results(jobs_list, job_count, tasks_list, task_count,
-                             context_switches, deadline_misses, completed_jobs, idle_time,
-                             hyperperiod, outfile);
+        if (pristine_jobs != NULL) {
+            report_mode_comparisons(tasks_list, task_count, pristine_jobs, job_count, hyperperiod, &cli.sim, &cache, &counters, outfile);
+            free(pristine_jobs);
+        }
+    }
+
+    // --- What-If Re-simulations (resume from the last checkpoint before the first change) ---
+    for (int w = 0; w < cli.whatif_count; ++w) {
+        run_whatif_simulation(&cli, w, jobs_list, job_count, hyperperiod, &checkpoints, &cache, outfile);
+    }
+    if (cache.enabled) result_cache_report(&cache, outfile);
 
     // --- Cleanup ---
+    free_checkpoints(&checkpoints);
     fclose(outfile);
-    printf("Simulation finished. Results saved to %s\n", output_filename);
+    printf("Simulation finished. Results saved to %s\n", cli.output_filename);
 
     return 0;
 }
 
 
+// --- Command Line Handling ---
+// Usage: llf_analyzer <tasks> <aet> <output> [--checkpoint-interval N] [--whatif <tasks> <aet>]... [--cache-dir DIR]
+//        llf_analyzer <tasks> <aet> <output> --partition M [--fit ffd|bfd|wfd]
+//        llf_analyzer <tasks> <release trace> <output> --replay
+//        llf_analyzer --sensitivity <output> <tasks> [<tasks>...] [--threads N]
+// Scheduler options for both: [--policy mllf|llf] [--switch-cost N] [--preempt-cost N] [--reload-penalty N] [--precise-tmin] [--quiet-misses]
+//                              [--dvfs L1,L2,...,100] [--static-power S]
+int parse_cli_options(int argc, char *argv[], CliOptions* cli) {
+    memset(cli, 0, sizeof(*cli));
+    cli->sim.static_power = DEFAULT_STATIC_POWER;
+    const char* positional[3 + MAX_SENSITIVITY_SETS];
+    int positional_total = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--checkpoint-interval") == 0) {
+            if (i + 1 >= argc || (cli->checkpoint_interval = atoi(argv[++i])) <= 0) {
+                fprintf(stderr, "Error: --checkpoint-interval requires a positive tick count.\n"); return 0;
+            }
+        } else if (strcmp(argv[i], "--whatif") == 0) {
+            if (i + 2 >= argc) { fprintf(stderr, "Error: --whatif requires a task file and an AET file.\n"); return 0; }
+            if (cli->whatif_count >= MAX_WHATIF_RUNS) { fprintf(stderr, "Error: At most %d --whatif runs supported.\n", MAX_WHATIF_RUNS); return 0; }
+            strncpy(cli->whatif_task_filenames[cli->whatif_count], argv[++i], MAX_FILENAME_LEN - 1);
+            strncpy(cli->whatif_aet_filenames[cli->whatif_count], argv[++i], MAX_FILENAME_LEN - 1);
+            cli->whatif_count++;
+        } else if (strcmp(argv[i], "--policy") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "Error: --policy requires mllf or llf.\n"); return 0; }
+            i++;
+            if (strcmp(argv[i], "mllf") == 0) cli->sim.policy = POLICY_MLLF;
+            else if (strcmp(argv[i], "llf") == 0) cli->sim.policy = POLICY_LLF;
+            else { fprintf(stderr, "Error: Unknown policy %s (expected mllf or llf).\n", argv[i]); return 0; }
+        } else if (strcmp(argv[i], "--switch-cost") == 0 || strcmp(argv[i], "--preempt-cost") == 0 || strcmp(argv[i], "--reload-penalty") == 0) {
+            int* target = (argv[i][2] == 's') ? &cli->sim.switch_cost : (argv[i][2] == 'p') ? &cli->sim.preempt_cost : &cli->sim.reload_penalty;
+            if (i + 1 >= argc || (*target = atoi(argv[i + 1])) < 0) { fprintf(stderr, "Error: %s requires a non-negative tick count.\n", argv[i]); return 0; }
+            i++;
+        } else if (strcmp(argv[i], "--dvfs") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "Error: --dvfs requires a comma separated list of frequency levels in %%.\n"); return 0; }
+            if (!parse_frequency_levels(argv[++i], &cli->sim)) return 0;
+        } else if (strcmp(argv[i], "--static-power") == 0) {
+            if (i + 1 >= argc || (cli->sim.static_power = atof(argv[++i])) < 0.0 || cli->sim.static_power >= 1.0) {
+                fprintf(stderr, "Error: --static-power requires a share of full-speed power in [0, 1).\n"); return 0;
+            }
+        } else if (strcmp(argv[i], "--quiet-misses") == 0) {
+            cli->sim.quiet_misses = true;
+        } else if (strcmp(argv[i], "--precise-tmin") == 0) {
+            cli->sim.precise_tmin = true;
+        } else if (strcmp(argv[i], "--partition") == 0) {
+            if (i + 1 >= argc || (cli->partition_cores = atoi(argv[++i])) <= 0 || cli->partition_cores > MAX_CORES) {
+                fprintf(stderr, "Error: --partition requires a core count between 1 and %d.\n", MAX_CORES); return 0;
+            }
+        } else if (strcmp(argv[i], "--fit") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "Error: --fit requires ffd, bfd or wfd.\n"); return 0; }
+            i++;
+            if (strcmp(argv[i], "ffd") == 0) cli->fit = FIT_FIRST;
+            else if (strcmp(argv[i], "bfd") == 0) cli->fit = FIT_BEST;
+            else if (strcmp(argv[i], "wfd") == 0) cli->fit = FIT_WORST;
+            else { fprintf(stderr, "Error: Unknown fit heuristic %s (expected ffd, bfd or wfd).\n", argv[i]); return 0; }
+        } else if (strcmp(argv[i], "--cache-dir") == 0) {
+            if (i + 1 >= argc) { fprintf(stderr, "Error: --cache-dir requires a directory.\n"); return 0; }
+            strncpy(cli->cache_dir, argv[++i], MAX_FILENAME_LEN - 1);
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            cli->replay_mode = true;
+        } else if (strcmp(argv[i], "--sensitivity") == 0) {
+            cli->sensitivity_mode = true;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            if (i + 1 >= argc || (cli->thread_count = atoi(argv[++i])) <= 0) {
+                fprintf(stderr, "Error: --threads requires a positive count.\n"); return 0;
+            }
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Error: Unknown option %s.\n", argv[i]); return 0;
+        } else {
+            if (positional_total >= (int)(sizeof(positional) / sizeof(positional[0]))) { fprintf(stderr, "Error: Unexpected argument %s.\n", argv[i]); return 0; }
+            positional[positional_total++] = argv[i];
+        }
+    }
+
+    if (cli->sensitivity_mode) {
+        if (positional_total < 2 || positional_total > 1 + MAX_SENSITIVITY_SETS) {
+            fprintf(stderr, "Usage: %s --sensitivity <output file> <task file> [<task file>...] (at most %d sets) [--threads N]\n", argv[0], MAX_SENSITIVITY_SETS);
+            return 0;
+        }
+        strncpy(cli->output_filename, positional[0], MAX_FILENAME_LEN - 1); // memset above guarantees termination
+        for (int i = 1; i < positional_total; ++i) {
+            strncpy(cli->sensitivity_set_filenames[cli->sensitivity_set_count++], positional[i], MAX_FILENAME_LEN - 1);
+        }
+        cli->positional_count = positional_total;
+        return 1;
+    }
+
+    if (cli->partition_cores > 0 && (cli->whatif_count > 0 || cli->cache_dir[0] != '\0')) {
+        fprintf(stderr, "Error: --partition cannot be combined with --whatif or --cache-dir.\n"); return 0;
+    }
+    if (cli->replay_mode && (cli->whatif_count > 0 || cli->cache_dir[0] != '\0' || cli->partition_cores > 0)) {
+        fprintf(stderr, "Error: --replay cannot be combined with --whatif, --cache-dir or --partition.\n"); return 0;
+    }
+    // Both modes need the whole job set on one core for their comparison reports
+    if ((cli->partition_cores > 0 || cli->replay_mode) && (cli->sim.frequency_level_count > 0 || cli->sim.precise_tmin)) {
+        fprintf(stderr, "Error: --dvfs and --precise-tmin cannot be combined with --partition or --replay.\n"); return 0;
+    }
+    if (cli->replay_mode && positional_total != 3) {
+        fprintf(stderr, "Usage: %s <task file> <release trace> <output file> --replay\n", argv[0]); return 0;
+    }
+    if (positional_total != 0 && positional_total != 3) {
+        fprintf(stderr, "Usage: %s <task file> <AET file> <output file> [--checkpoint-interval N] [--whatif <task file> <AET file>]... [--cache-dir DIR] [--partition M [--fit ffd|bfd|wfd]]\n", argv[0]);
+        return 0;
+    }
+    if (positional_total == 3) {
+        strncpy(cli->task_filename, positional[0], MAX_FILENAME_LEN - 1);
+        strncpy(cli->aet_filename, positional[1], MAX_FILENAME_LEN - 1);
+        strncpy(cli->output_filename, positional[2], MAX_FILENAME_LEN - 1);
+    }
+    cli->positional_count = positional_total;
+    return 1;
+}
+
+// 0 = one thread per online core, capped at MAX_PROBE_THREADS
+int resolve_thread_count(int requested) {
+    int count = requested;
+    if (count <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        count = (cores > 0) ? (int)cores : 1;
+    }
+    return (count > MAX_PROBE_THREADS) ? MAX_PROBE_THREADS : count;
+}
+
+
 // --- Helper Function Implementations ---
 long long gcd(long long a, long long b) {
     if (a < 0) a = -a; if (b < 0) b = -b;
@@ -242,6 +694,7 @@ int generate_jobs(long long hyperperiod, const Task tasks_arr[], int task_count,
             current_job_ptr->status = NOT_ARRIVED;
             current_job_ptr->first_start_time = -1;
             current_job_ptr->last_start_time = -1;
+            current_job_ptr->partial_work = 0;
             current_job_ptr->finish_time = -1;
             current_job_ptr->response_time = -1;
             current_job_ptr->turnaround_time = -1;
@@ -280,6 +733,29 @@ int read_actual_execution_times(const char* filename, Job jobs_arr[], int job_co
     return 1;
 }
 
+// Reads tasks + AETs and generates the job set. Returns 1 on success, 0 on error, -1 if there is nothing to simulate.
+int load_job_set(const char* task_filename, const char* aet_filename, Task tasks_arr[], int* task_count,
+                 Job jobs_arr[], int* job_count, int* hyperperiod) {
+    if (!read_tasks(task_filename, tasks_arr, task_count)) return 0;
+    if (*task_count == 0) { printf("No tasks loaded.\n"); return -1; }
+
+    long long hyperperiod_ll = calculate_hyperperiod(tasks_arr, *task_count);
+    if (hyperperiod_ll <= 0 || hyperperiod_ll == -2) { fprintf(stderr, "Error: Invalid or excessive hyperperiod (%lld).\n", hyperperiod_ll); return 0; }
+    if (hyperperiod_ll > INT_MAX) { fprintf(stderr, "Error: Hyperperiod exceeds INT_MAX.\n"); return 0; }
+    *hyperperiod = (int)hyperperiod_ll;
+
+    if (!generate_jobs(*hyperperiod, tasks_arr, *task_count, jobs_arr, job_count)) return 0;
+    if (*job_count == 0) { printf("No jobs generated within hyperperiod.\n"); return -1; }
+
+     // Initialize calculated_laxity
+    for (int i = 0; i < *job_count; ++i) {
+        jobs_arr[i].calculated_laxity = INT_MAX; // Initialize
+    }
+
+    if (!read_actual_execution_times(aet_filename, jobs_arr, *job_count)) return 0;
+    return 1;
+}
+
 void add_job_to_ready_queue(SimulationState* state, Job* job) {
     if (job->status != READY) { return; } // Only add ready jobs
     // Avoid duplicates
@@ -320,6 +796,13 @@ void calculate_all_laxities(SimulationState* state) {
 }
 
 
+// Final tie-break order: task, then instance. This is job ID order for generated jobs (numbered task by
+// task); replayed jobs are numbered in release order, so their IDs cannot be used.
+bool job_precedes(const Job* a, const Job* b) {
+    if (a->task_id != b->task_id) return a->task_id < b->task_id;
+    return a->instance_number < b->instance_number;
+}
+
 // Selects the MLLF task Ta
 Job* select_mllf_task_Ta(SimulationState* state) {
     Job* task_Ta = NULL;
@@ -356,8 +839,8 @@ Job* select_mllf_task_Ta(SimulationState* state) {
              min_remaining_wcet_at_min_laxity = state->running_job->remaining_wcet;
              task_Ta = state->running_job;
         } else if (state->running_job->remaining_wcet == min_remaining_wcet_at_min_laxity) {
-            // Tie break with Job ID if WCETs are also equal
-            if (task_Ta == NULL || state->running_job->job_id < task_Ta->job_id) {
+            // Tie break with job order if WCETs are also equal
+            if (task_Ta == NULL || job_precedes(state->running_job, task_Ta)) {
                  task_Ta = state->running_job;
             }
         }
@@ -371,8 +854,8 @@ Job* select_mllf_task_Ta(SimulationState* state) {
                 min_remaining_wcet_at_min_laxity = current_job->remaining_wcet;
                 task_Ta = current_job;
             } else if (current_job->remaining_wcet == min_remaining_wcet_at_min_laxity) {
-                 // Tie break with Job ID if WCETs are also equal
-                 if (task_Ta == NULL || current_job->job_id < task_Ta->job_id) {
+                 // Tie break with job order if WCETs are also equal
+                 if (task_Ta == NULL || job_precedes(current_job, task_Ta)) {
                       task_Ta = current_job;
                  }
             }
@@ -406,6 +889,11 @@ int find_earliest_deadline_higher_laxity_job_deadline(SimulationState* state, Jo
          int current_job_laxity = INT_MAX;
          if (current_job->status == READY || current_job->status == RUNNING) {
              current_job_laxity = current_job->calculated_laxity; // Use pre-calculated
+         } else if (current_job->status == NOT_ARRIVED && state->options->precise_tmin) {
+             // Precise mode: project the job's laxity at its release. Ta's laxity stays constant while it
+             // runs, so the job constrains Ta only if it will arrive with more laxity than Ta has now.
+             // Jobs arriving with less laxity trigger a reschedule on arrival anyway.
+             current_job_laxity = current_job->absolute_deadline - current_job->arrival_time - current_job->remaining_wcet;
          } else if (current_job->status == NOT_ARRIVED) {
              // Laxity doesn't really apply yet, but we need its deadline
              // We only care about jobs with deadlines, assume laxity check passes for future tasks
@@ -442,6 +930,9 @@ int calculate_mllf_quantum(SimulationState* state, Job* task_Ta, Job jobs_arr[],
     if (task_Ta == NULL || task_Ta->remaining_aet <= 0) {
         return 0; // No quantum if no task or task already finished AET
     }
+    if (state->options->policy == POLICY_LLF) {
+        return 1; // Plain LLF: laxities are re-evaluated at every tick
+    }
 
     int D_min = find_earliest_deadline_higher_laxity_job_deadline(state, task_Ta, jobs_arr, job_count);
     int D_a = task_Ta->absolute_deadline;
@@ -487,7 +978,7 @@ void handle_completion(SimulationState* state) {
      if (state->running_job != NULL && state->running_job->remaining_aet <= 0 && state->running_job->status != COMPLETED && state->running_job->status != MISSED) {
         state->running_job->status = COMPLETED;
         state->running_job->finish_time = state->current_time; // Completed at start of this tick
-        (*(state->completed_jobs_ptr))++;
+        state->counters->completed_jobs++;
         // Logging handled in run_simulation
         state->running_job = NULL; // CPU is now free
         state->current_job_quantum_remaining = 0; // Reset quantum
@@ -519,7 +1010,7 @@ void make_mllf_scheduling_decision(SimulationState* state, Job* candidate_Ta, ch
         } else {
             // Still Idle
             strncat(event_log, "CPU Idle ", log_size - strlen(event_log) - 1);
-            (*(state->idle_time_ptr))++;
+            state->counters->idle_time++;
             state->current_job_quantum_remaining = 0;
         }
     } else { // --- CPU Busy ---
@@ -561,15 +1052,19 @@ void make_mllf_scheduling_decision(SimulationState* state, Job* candidate_Ta, ch
             // Continue Condition: Rescheduling selected the *same* task Ta
             // OR no rescheduling event occurred (quantum not expired, no arrival/completion)
 
-             // We might need to recalculate quantum if an arrival occurred, even if Ta is the same
-             // For simplicity, let's assume quantum is recalculated only when Ta changes or expires.
-             // A more precise implementation might recalculate quantum on every arrival.
+             // By default the quantum is recalculated only when Ta changes or expires.
+             // In precise Tmin mode it is also recalculated on every arrival, since the arrival changes the Tmin set.
 
             // Check if quantum needs resetting (e.g., after expiry last tick)
              if (state->current_job_quantum_remaining <= 0 && state->running_job->remaining_aet > 0) {
                  state->current_job_quantum_remaining = calculate_mllf_quantum(state, state->running_job, jobs_arr, job_count);
+                 state->counters->resetq_events++;
                   char resetq_msg[60]; snprintf(resetq_msg, sizeof(resetq_msg), "ResetQ J%d(L%d,Q%d) ", state->running_job->job_id, state->running_job->calculated_laxity, state->current_job_quantum_remaining);
                   strncat(event_log, resetq_msg, log_size - strlen(event_log) - 1);
+             } else if (state->options->precise_tmin && state->arrival_this_tick) {
+                 state->current_job_quantum_remaining = calculate_mllf_quantum(state, state->running_job, jobs_arr, job_count);
+                  char requantum_msg[60]; snprintf(requantum_msg, sizeof(requantum_msg), "ReQ J%d(L%d,Q%d) ", state->running_job->job_id, state->running_job->calculated_laxity, state->current_job_quantum_remaining);
+                  strncat(event_log, requantum_msg, log_size - strlen(event_log) - 1);
              } else {
                  // Just continue
                   char cont_msg[60]; snprintf(cont_msg, sizeof(cont_msg), "Continue J%d(L%d,Q%d) ", state->running_job->job_id, state->running_job->calculated_laxity, state->current_job_quantum_remaining);
@@ -583,38 +1078,80 @@ void make_mllf_scheduling_decision(SimulationState* state, Job* candidate_Ta, ch
 
      // Check context switch: only if the running job ID actually changed between *non-idle* states
      int current_running_job_id = (state->running_job == NULL) ? -1 : state->running_job->job_id;
+     bool context_switch = false;
      if (current_running_job_id != state->last_running_job_id && // ID changed
          current_running_job_id != -1 && // New state is not idle
          state->last_running_job_id != -1) // Old state was not idle
          {
-          (*(state->context_switches_ptr))++; strncat(event_log, "(CS) ", log_size - strlen(event_log) - 1);
+          state->counters->context_switches++; strncat(event_log, "(CS) ", log_size - strlen(event_log) - 1);
+          context_switch = true;
      }
      state->last_running_job_id = current_running_job_id;
+
+     // A new dispatch pays its overheads; the previous job was preempted if it went back to READY unfinished
+     if (state->running_job != NULL && state->running_job != previously_running) {
+         bool preemption = (previously_running != NULL && previously_running->status == READY);
+         charge_dispatch_overhead(state, context_switch, preemption, event_log, log_size);
+     }
+}
+
+// Sets the ticks the new running job waits before progressing. Replaces any unpaid overhead of the
+// dispatch it displaced. A dispatched job that started earlier is resuming after a preemption.
+void charge_dispatch_overhead(SimulationState* state, bool context_switch, bool preemption, char* event_log, size_t log_size) {
+    const SimulationOptions* options = state->options;
+    int cost = 0;
+    if (context_switch) cost += options->switch_cost;
+    if (preemption) { state->counters->preemptions++; cost += options->preempt_cost; }
+    if (state->running_job->first_start_time < state->current_time) { state->counters->reload_events++; cost += options->reload_penalty; }
+    state->overhead_remaining = cost;
+    if (cost > 0) {
+        char overhead_msg[20]; snprintf(overhead_msg, sizeof(overhead_msg), "(OH%d) ", cost);
+        strncat(event_log, overhead_msg, log_size - strlen(event_log) - 1);
+    }
+}
+
+const char* policy_name(SchedulingPolicy policy) {
+    return (policy == POLICY_LLF) ? "LLF" : "MLLF";
 }
 
 void execute_running_job(SimulationState* state) {
      if (state->running_job != NULL && state->running_job->status == RUNNING) {
-        if (state->running_job->remaining_aet > 0) state->running_job->remaining_aet--;
-        if (state->running_job->remaining_wcet > 0) state->running_job->remaining_wcet--;
+        bool dvfs = (state->options->frequency_level_count > 0);
+        if (dvfs) state->counters->level_ticks[state->speed_level]++;
+        // Dispatch overhead occupies the CPU first; it neither advances the job nor consumes its quantum
+        if (state->overhead_remaining > 0) {
+            state->overhead_remaining--;
+            state->counters->overhead_time++;
+            return;
+        }
+        // Below full speed a tick completes only part of a unit of work; whole units are credited as they accumulate
+        bool unit_done = true;
+        if (dvfs) {
+            state->running_job->partial_work += state->options->frequency_levels[state->speed_level];
+            unit_done = (state->running_job->partial_work >= 100);
+            if (unit_done) state->running_job->partial_work -= 100;
+        }
+        if (unit_done && state->running_job->remaining_aet > 0) state->running_job->remaining_aet--;
+        if (unit_done && state->running_job->remaining_wcet > 0) state->running_job->remaining_wcet--;
 
-        // Decrement quantum as well
-        if (state->current_job_quantum_remaining > 0) {
+        // Decrement quantum as well. It counts work units like the laxities it was derived from, so a
+        // slowed job is not cut off before it did the work the quantum was sized for.
+        if (unit_done && state->current_job_quantum_remaining > 0) {
              state->current_job_quantum_remaining--;
         }
     }
 }
 
-void check_deadline_misses(SimulationState* state, Job jobs_arr[], int job_count, FILE* outfile) {
+void check_deadline_misses(SimulationState* state, Job jobs_arr[], int job_count) {
     int next_time = state->current_time + 1; // Check deadline against the *end* of the current tick
 
     // Check running job first
     if (state->running_job != NULL && state->running_job->status == RUNNING) {
         // Miss occurs if deadline is *at* or before current time end, and job isn't finished
-        if (next_time > state->running_job->absolute_deadline && state->running_job->remaining_aet > 0) {
-            fprintf(outfile, "!!! DEADLINE MISS: J%d deadline %d at time %d !!!\n", state->running_job->job_id, state->running_job->absolute_deadline, next_time);
-            printf("!!! DEADLINE MISS: J%d deadline %d at time %d !!!\n", state->running_job->job_id, state->running_job->absolute_deadline, next_time);
+        if (next_time >= state->running_job->absolute_deadline && state->running_job->remaining_aet > 0) {
+            trace_deadline_miss(state, state->running_job, next_time);
             state->running_job->status = MISSED;
-            (*(state->deadline_misses_ptr))++;
+            state->counters->deadline_misses++;
             state->running_job = NULL; // Remove from CPU
             state->current_job_quantum_remaining = 0;
         }
@@ -624,11 +1161,10 @@ void check_deadline_misses(SimulationState* state, Job jobs_arr[], int job_count
     // Iterate backwards for safe removal
     for (int i = state->ready_queue_size - 1; i >= 0; --i) {
         Job* job_to_check = state->ready_queue[i];
-        if (next_time > job_to_check->absolute_deadline) {
-            fprintf(outfile, "!!! DEADLINE MISS: J%d deadline %d at time %d !!!\n", job_to_check->job_id, job_to_check->absolute_deadline, next_time);
-            printf("!!! DEADLINE MISS: J%d deadline %d at time %d !!!\n", job_to_check->job_id, job_to_check->absolute_deadline, next_time);
+        if (next_time >= job_to_check->absolute_deadline) { // Ready jobs always have work left
+            trace_deadline_miss(state, job_to_check, next_time);
             job_to_check->status = MISSED;
-            (*(state->deadline_misses_ptr))++;
+            state->counters->deadline_misses++;
             remove_job_from_ready_queue(state, job_to_check);
             // No need to adjust index 'i' when iterating backwards
         }
@@ -636,140 +1172,443 @@ void check_deadline_misses(SimulationState* state, Job jobs_arr[], int job_count
 }
 
 
-// *** Renamed and modified simulation loop ***
-void run_mllf_simulation(int hyperperiod, Job jobs_arr[], int job_count, FILE* outfile,
-                         int* context_switches, int* deadline_misses, int* completed_jobs, int* idle_time) {
+void trace_deadline_miss(SimulationState* state, const Job* job, int time) {
+    if (state->trace == NULL) return; // Silent run (e.g. sensitivity probes)
+    TraceRecord* record = trace_writer_claim(state->trace);
+    record->type = TRACE_DEADLINE_MISS;
+    record->time = time;
+    record->job_id = job->job_id;
+    record->deadline = job->absolute_deadline;
+    trace_writer_publish(state->trace);
+}
 
-    fprintf(outfile, "\n--- MLLF Simulation Trace (Hyperperiod: %d) ---\n", hyperperiod);
-    fprintf(outfile, "Time | Event%-40s | Run Job(L,Q)| Ready Queue (JobId:Laxity)\n", ""); // Adjusted header
-    fprintf(outfile, "-----|--------------------------------------------|--------------|--------------------------\n");
 
-    // Initialize simulation state
-    SimulationState state;
-    state.ready_queue_size = 0;
-    state.running_job = NULL;
-    state.current_time = 0;
-    state.last_running_job_id = -1;
-    state.current_job_quantum_remaining = 0; // Init quantum
-    state.context_switches_ptr = context_switches;
-    state.deadline_misses_ptr = deadline_misses;
-    state.completed_jobs_ptr = completed_jobs;
-    state.idle_time_ptr = idle_time;
-    *context_switches = 0; // Reset counters
-    *deadline_misses = 0;
-    *completed_jobs = 0;
-    *idle_time = 0;
-
-
-    while (state.current_time < hyperperiod) {
-        char event_log[150] = ""; // Event log for the current time tick
-        bool requires_reschedule = false; // Flag to force rescheduling
-
-        // Step 1: Handle Arrivals & Check if arrival requires rescheduling
-        bool new_arrival_occurred = false;
-        for (int i = 0; i < job_count; i++) {
-             if (jobs_arr[i].status == NOT_ARRIVED && jobs_arr[i].arrival_time == state.current_time) {
-                 jobs_arr[i].status = READY;
-                 add_job_to_ready_queue(&state, &jobs_arr[i]);
-                 char arrival_msg[40]; snprintf(arrival_msg, sizeof(arrival_msg), "Arrival J%d(T%d) ", jobs_arr[i].job_id, jobs_arr[i].task_id);
-                 strncat(event_log, arrival_msg, sizeof(event_log) - strlen(event_log) - 1);
-                 requires_reschedule = true; // MLLF reschedules on arrival
-                 new_arrival_occurred = true;
-             }
+// --- DVFS Slack Reclamation ---
+// Cycle-conserving speed selection: each task contributes WCET / relative deadline from its release
+// until the job completes, then only the work it actually used until the next release. That sum only
+// keeps deadlines under EDF, so the speed must also cover the remaining WCET of the active jobs due by
+// each active deadline within the time left until it.
+// Both are rates, but MLLF does not run jobs in deadline order, its laxities stay in full-speed work
+// units and a job finishing inside a slowed tick wastes the rest of it. A level is therefore only used
+// if the whole ticks it adds to the running job fit the slack of every pending job (ready, or released
+// up to the latest pending deadline): the time left to its deadline minus the full-speed ticks, with
+// worst-case dispatch overhead, of the running job and of every pending job released before that
+// deadline. The speed is chosen again every tick, so full speed stays feasible whenever that holds.
+
+void dvfs_note_release(SimulationState* state, const Job* job) {
+    int window = job->absolute_deadline - job->arrival_time;
+    state->task_share[job->task_id] = (double)job->wcet / window;
+}
+
+void dvfs_note_completion(SimulationState* state, const Job* job) {
+    int window = job->absolute_deadline - job->arrival_time;
+    state->task_share[job->task_id] = (double)job->aet / window; // Slack (WCET - AET) is reclaimed
+}
+
+// Remaining worst-case work of a job in % of one full-speed tick
+int dvfs_work_left(const Job* job) {
+    return job->remaining_wcet * 100 - job->partial_work;
+}
+
+// Smallest slack in whole ticks over the pending jobs (see above); negative if full speed is already late
+int dvfs_min_slack(const SimulationState* state, const Job jobs_arr[], int job_count) {
+    // Pending jobs: the ready queue plus every release up to the latest pending deadline (a release right
+    // at it may lose the idle tick it would have started after, and pay a context switch). A release can
+    // extend that deadline, so scan again until the horizon stops growing.
+    const Job* job = state->running_job;
+    const Job* pending[MAX_JOBS];
+    int pending_count = 0, horizon = job->absolute_deadline;
+    for (int k = 0; k < state->ready_queue_size; ++k) {
+        pending[pending_count++] = state->ready_queue[k];
+        if (state->ready_queue[k]->absolute_deadline > horizon) horizon = state->ready_queue[k]->absolute_deadline;
+    }
+    for (int scanned = state->current_time + 1; scanned <= horizon; ) {
+        int next_horizon = horizon;
+        for (int i = 0; i < job_count && pending_count < MAX_JOBS; ++i) {
+            const Job* release = &jobs_arr[i];
+            if (release->status != NOT_ARRIVED || release->arrival_time < scanned || release->arrival_time > horizon) continue;
+            pending[pending_count++] = release;
+            if (release->absolute_deadline > next_horizon) next_horizon = release->absolute_deadline;
+        }
+        scanned = horizon + 1; horizon = next_horizon;
+    }
+
+    int start = state->current_time + state->overhead_remaining; // Dispatch overhead runs first
+    int running_ticks = (dvfs_work_left(job) + 99) / 100;
+    const SimulationOptions* options = state->options;
+    // Worst case per dispatch; a pending job costs its own plus resuming the job it preempted, and the
+    // running job may be preempted and resumed once more itself
+    int dispatch_cost = options->switch_cost + options->preempt_cost + options->reload_penalty;
+    int min_slack = INT_MAX;
+    for (int i = -1; i < pending_count; ++i) {
+        const Job* due = (i < 0) ? job : pending[i];
+        int ticks = running_ticks + dispatch_cost; // The running job delays everything behind it, whatever its deadline
+        for (int k = 0; k < pending_count; ++k) {
+            const Job* other = pending[k];
+            if (other->arrival_time >= due->absolute_deadline) continue;
+            int other_ticks = (dvfs_work_left(other) + 99) / 100 + 2 * dispatch_cost;
+            if (other->absolute_deadline > due->absolute_deadline) {
+                // Due later, but its laxity may fall below ours while it waits: count what fits before our deadline
+                int from = (other->arrival_time > state->current_time) ? other->arrival_time : state->current_time;
+                if (other_ticks > due->absolute_deadline - from) other_ticks = due->absolute_deadline - from;
+            }
+            ticks += other_ticks;
+        }
+        int slack = due->absolute_deadline - start - ticks;
+        if (slack < min_slack) min_slack = slack;
+    }
+    return min_slack;
+}
+
+void select_dvfs_speed(SimulationState* state, const Job jobs_arr[], int job_count, char* event_log, size_t log_size) {
+    const SimulationOptions* options = state->options;
+    double demand = 0.0;
+    for (int tid = 0; tid < MAX_TASKS; ++tid) demand += state->task_share[tid];
+
+    // Demand of the active jobs: work due by each active deadline over the time left until it
+    const Job* job = state->running_job;
+    int start = state->current_time + state->overhead_remaining; // Dispatch overhead runs first
+    for (int i = -1; i < state->ready_queue_size; ++i) {
+        const Job* due = (i < 0) ? job : state->ready_queue[i];
+        int work = (job->absolute_deadline <= due->absolute_deadline) ? dvfs_work_left(job) : 0;
+        for (int k = 0; k < state->ready_queue_size; ++k) {
+            if (state->ready_queue[k]->absolute_deadline <= due->absolute_deadline) work += dvfs_work_left(state->ready_queue[k]);
+        }
+        int window = due->absolute_deadline - start;
+        double window_demand = (window > 0) ? work / (100.0 * window) : 1.0;
+        if (window_demand > demand) demand = window_demand;
+    }
+
+    int level = options->frequency_level_count - 1;
+    for (int l = 0; l < options->frequency_level_count; ++l) {
+        if (options->frequency_levels[l] >= demand * 100.0 - 1e-9) { level = l; break; }
+    }
+    // Slow down only as far as the slack of the pending jobs absorbs the extra ticks
+    if (options->frequency_levels[level] < 100) {
+        int min_slack = dvfs_min_slack(state, jobs_arr, job_count);
+        int work_left = dvfs_work_left(job);
+        int full_speed_ticks = (work_left + 99) / 100;
+        while (options->frequency_levels[level] < 100) {
+            int speed = options->frequency_levels[level];
+            if ((work_left + speed - 1) / speed - full_speed_ticks <= min_slack) break;
+            level++;
         }
+    }
+    if (level != state->speed_level) {
+        char speed_msg[20]; snprintf(speed_msg, sizeof(speed_msg), "Speed %d%% ", options->frequency_levels[level]);
+        strncat(event_log, speed_msg, log_size - strlen(event_log) - 1);
+        state->speed_level = level;
+    }
+}
+
+
+void init_simulation_state(SimulationState* state, const SimulationOptions* options, SimulationCounters* counters) {
+    state->ready_queue_size = 0;
+    state->running_job = NULL;
+    state->current_time = 0;
+    state->last_running_job_id = -1;
+    state->current_job_quantum_remaining = 0; // Init quantum
+    state->overhead_remaining = 0;
+    state->arrival_this_tick = false;
+    state->trace = NULL;
+    state->speed_level = options->frequency_level_count - 1; // Full speed
+    memset(state->task_share, 0, sizeof(state->task_share)); // A task demands nothing before its first release
+    state->options = options;
+    state->counters = counters;
+    memset(counters, 0, sizeof(*counters)); // Reset counters
+}
 
+// One simulation tick: arrivals, completion, quantum expiry, rescheduling, trace, execution, misses, time advance
+void simulate_mllf_tick(SimulationState* state, Job jobs_arr[], int job_count) {
+    char event_log[EVENT_LOG_SIZE] = ""; // Event log for the current time tick
+    bool requires_reschedule = false; // Flag to force rescheduling
 
-        // Step 2: Handle Completion of the previously running job
-        bool completion_occurred = false;
-         if (state.running_job != NULL && state.running_job->remaining_aet <= 0 && state.running_job->status != COMPLETED && state.running_job->status != MISSED) {
-            char complete_msg[40]; snprintf(complete_msg, sizeof(complete_msg), "Complete J%d ", state.running_job->job_id);
-            strncat(event_log, complete_msg, sizeof(event_log) - strlen(event_log) - 1);
-            handle_completion(&state); // Sets running_job to NULL, increments counter
-            completion_occurred = true;
-            requires_reschedule = true; // Completion requires rescheduling
+    // Step 1: Handle Arrivals & Check if arrival requires rescheduling
+    bool new_arrival_occurred = false;
+    state->arrival_this_tick = false;
+    for (int i = 0; i < job_count; i++) {
+         if (jobs_arr[i].status == NOT_ARRIVED && jobs_arr[i].arrival_time == state->current_time) {
+             jobs_arr[i].status = READY;
+             add_job_to_ready_queue(state, &jobs_arr[i]);
+             if (state->options->frequency_level_count > 0) dvfs_note_release(state, &jobs_arr[i]);
+             char arrival_msg[40]; snprintf(arrival_msg, sizeof(arrival_msg), "Arrival J%d(T%d) ", jobs_arr[i].job_id, jobs_arr[i].task_id);
+             strncat(event_log, arrival_msg, sizeof(event_log) - strlen(event_log) - 1);
+             requires_reschedule = true; // MLLF reschedules on arrival
+             new_arrival_occurred = true;
+             state->arrival_this_tick = true;
          }
+    }
 
 
-        // Step 3: Check for Quantum Expiration
-        bool quantum_expired = false;
-        if (state.running_job != NULL && state.current_job_quantum_remaining <= 0 && state.running_job->remaining_aet > 0) {
-             char quantum_msg[40]; snprintf(quantum_msg, sizeof(quantum_msg), "Quantum Exp J%d ", state.running_job->job_id);
-             strncat(event_log, quantum_msg, sizeof(event_log) - strlen(event_log) - 1);
-             requires_reschedule = true; // Quantum expiration requires rescheduling
-             quantum_expired = true;
-             // Do NOT put the job back to ready yet, the scheduler will decide if it continues or gets preempted
-        }
+    // Step 2: Handle Completion of the previously running job
+    bool completion_occurred = false;
+     if (state->running_job != NULL && state->running_job->remaining_aet <= 0 && state->running_job->status != COMPLETED && state->running_job->status != MISSED) {
+        char complete_msg[40]; snprintf(complete_msg, sizeof(complete_msg), "Complete J%d ", state->running_job->job_id);
+        strncat(event_log, complete_msg, sizeof(event_log) - strlen(event_log) - 1);
+        if (state->options->frequency_level_count > 0) dvfs_note_completion(state, state->running_job);
+        handle_completion(state); // Sets running_job to NULL, increments counter
+        completion_occurred = true;
+        requires_reschedule = true; // Completion requires rescheduling
+     }
+
 
-        // Step 4: Perform Rescheduling IF NEEDED
-        Job* candidate_Ta = NULL;
-        if (requires_reschedule || state.running_job == NULL) { // Reschedule if event occurred or CPU idle
-             candidate_Ta = select_mllf_task_Ta(&state);
-             // Make scheduling decision (handles start/preempt/continue/idle)
-             make_mllf_scheduling_decision(&state, candidate_Ta, event_log, sizeof(event_log), jobs_arr, job_count);
+    // Step 3: Check for Quantum Expiration
+    bool quantum_expired = false;
+    if (state->running_job != NULL && state->current_job_quantum_remaining <= 0 && state->running_job->remaining_aet > 0) {
+         char quantum_msg[40]; snprintf(quantum_msg, sizeof(quantum_msg), "Quantum Exp J%d ", state->running_job->job_id);
+         strncat(event_log, quantum_msg, sizeof(event_log) - strlen(event_log) - 1);
+         requires_reschedule = true; // Quantum expiration requires rescheduling
+         quantum_expired = true;
+         state->counters->quantum_expirations++;
+         // Do NOT put the job back to ready yet, the scheduler will decide if it continues or gets preempted
+    }
+
+    // Step 4: Perform Rescheduling IF NEEDED
+    Job* candidate_Ta = NULL;
+    if (requires_reschedule || state->running_job == NULL) { // Reschedule if event occurred or CPU idle
+         candidate_Ta = select_mllf_task_Ta(state);
+         // Make scheduling decision (handles start/preempt/continue/idle)
+         make_mllf_scheduling_decision(state, candidate_Ta, event_log, sizeof(event_log), jobs_arr, job_count);
+    } else {
+        // No specific event, running job continues (if any)
+        if (state->running_job != NULL) {
+             // Update laxity for logging
+             calculate_all_laxities(state);
+             char cont_msg[60]; snprintf(cont_msg, sizeof(cont_msg), "Continue J%d(L%d,Q%d) ", state->running_job->job_id, state->running_job->calculated_laxity, state->current_job_quantum_remaining);
+             strncat(event_log, cont_msg, sizeof(event_log) - strlen(event_log) - 1);
         } else {
-            // No specific event, running job continues (if any)
-            if (state.running_job != NULL) {
-                 // Update laxity for logging
-                 calculate_all_laxities(&state);
-                 char cont_msg[60]; snprintf(cont_msg, sizeof(cont_msg), "Continue J%d(L%d,Q%d) ", state.running_job->job_id, state.running_job->calculated_laxity, state.current_job_quantum_remaining);
-                 strncat(event_log, cont_msg, sizeof(event_log) - strlen(event_log) - 1);
-            } else {
-                 // CPU remains idle
-                 strncat(event_log, "CPU Idle ", sizeof(event_log) - strlen(event_log) - 1);
-                  (*(state.idle_time_ptr))++; // Increment idle time if no job runs
-            }
+             // CPU remains idle
+             strncat(event_log, "CPU Idle ", sizeof(event_log) - strlen(event_log) - 1);
+              state->counters->idle_time++; // Increment idle time if no job runs
         }
+    }
+
+
+    // Step 4b: DVFS picks the speed for this tick once the running job is known
+    if (state->options->frequency_level_count > 0 && state->running_job != NULL) {
+        select_dvfs_speed(state, jobs_arr, job_count, event_log, sizeof(event_log));
+    }
 
 
-        // Step 5: Log Current State to File
-        fprintf(outfile, "%4d | %-42s | ", state.current_time, event_log);
-        if (state.running_job != NULL) { fprintf(outfile, " J%-3d(L%d,Q%d)|", state.running_job->job_id, state.running_job->calculated_laxity, state.current_job_quantum_remaining); }
-        else { fprintf(outfile, " %-12s |", "Idle"); }
-        fprintf(outfile, " "); int chars_printed = 0;
-        // Sort ready queue by laxity for display? Optional. For now, just print.
-        for (int i = 0; i < state.ready_queue_size; ++i) {
-             chars_printed += fprintf(outfile, "J%d:%d ", state.ready_queue[i]->job_id, state.ready_queue[i]->calculated_laxity);
-             if (chars_printed > 18 && i < state.ready_queue_size -1) { fprintf(outfile, "..."); break; }
+    // Step 5: Record Current State for the trace writer (formatted and written off this thread)
+    if (state->trace != NULL) {
+        TraceRecord* record = trace_writer_claim(state->trace);
+        record->type = TRACE_TICK;
+        record->time = state->current_time;
+        memcpy(record->event_log, event_log, sizeof(event_log));
+        record->running_job_id = (state->running_job != NULL) ? state->running_job->job_id : -1;
+        if (state->running_job != NULL) {
+            record->running_laxity = state->running_job->calculated_laxity;
+            record->running_quantum = state->current_job_quantum_remaining;
         }
-        fprintf(outfile, "\n");
+        record->ready_count = state->ready_queue_size;
+        for (int i = 0; i < state->ready_queue_size && i < TRACE_READY_PREVIEW; ++i) {
+            record->ready_job_ids[i] = state->ready_queue[i]->job_id;
+            record->ready_laxities[i] = state->ready_queue[i]->calculated_laxity;
+        }
+        trace_writer_publish(state->trace);
+    }
 
 
-        // Step 6: Execute Running Job (decrement remaining AET/WCET and quantum)
-        execute_running_job(&state);
+    // Step 6: Execute Running Job (decrement remaining AET/WCET and quantum)
+    execute_running_job(state);
 
-        // Step 7: Check for Deadline Misses (at the end of the tick)
-        check_deadline_misses(&state, jobs_arr, job_count, outfile);
+    // Step 7: Check for Deadline Misses (at the end of the tick)
+    check_deadline_misses(state, jobs_arr, job_count);
 
-        // Step 8: Advance Time
-        state.current_time++;
+    // Step 8: Advance Time
+    state->current_time++;
+}
+
+// Runs ticks until end_time, capturing a checkpoint at every multiple of the store's interval
+void advance_mllf_simulation(SimulationState* state, int end_time, Job jobs_arr[], int job_count, CheckpointStore* checkpoints) {
+    while (state->current_time < end_time) {
+        if (checkpoints != NULL && state->current_time % checkpoints->interval == 0) {
+            save_checkpoint(checkpoints, state, jobs_arr, job_count);
+        }
+        simulate_mllf_tick(state, jobs_arr, job_count);
     } // End simulation loop
+}
+
+
+// *** Renamed and modified simulation loop ***
+void run_mllf_simulation(int hyperperiod, Job jobs_arr[], int job_count, FILE* outfile,
+                         const SimulationOptions* options, SimulationCounters* counters, CheckpointStore* checkpoints) {
+
+    if (outfile != NULL) { // NULL outfile = no trace
+        fprintf(outfile, "\n--- %s Simulation Trace (Hyperperiod: %d) ---\n", policy_name(options->policy), hyperperiod);
+        fprintf(outfile, "Time | Event%-40s | Run Job(L,Q)| Ready Queue (JobId:Laxity)\n", ""); // Adjusted header
+        fprintf(outfile, "-----|--------------------------------------------|--------------|--------------------------\n");
+    }
+
+    // Initialize simulation state
+    SimulationState state;
+    init_simulation_state(&state, options, counters);
+    if (checkpoints != NULL) checkpoints->job_count = job_count;
+    TraceWriter writer;
+    if (outfile != NULL && trace_writer_start(&writer, outfile, !options->quiet_misses)) state.trace = &writer;
+
+    advance_mllf_simulation(&state, hyperperiod, jobs_arr, job_count, checkpoints);
+
+    if (state.trace != NULL) trace_writer_stop(&writer); // Drains the ring before the footer is written
+    if (outfile != NULL) fprintf(outfile, "-----|--------------------------------------------|--------------|--------------------------\n");
+}
 
+// Continues a run from the last checkpoint at or before divergence_time. jobs_arr must hold the freshly
+// generated (modified) job set. Returns the tick the simulation resumed from (0 = full run).
+int resume_mllf_simulation(int hyperperiod, Job jobs_arr[], int job_count, FILE* outfile,
+                           const SimulationOptions* options, SimulationCounters* counters,
+                           const CheckpointStore* checkpoints, int divergence_time) {
+    const SimulationCheckpoint* checkpoint = NULL;
+    if (checkpoints != NULL && checkpoints->job_count == job_count) {
+        checkpoint = find_checkpoint_at_or_before(checkpoints, divergence_time);
+    }
+    if (checkpoint == NULL || checkpoint->time == 0) {
+        run_mllf_simulation(hyperperiod, jobs_arr, job_count, outfile, options, counters, NULL);
+        return 0;
+    }
+
+    fprintf(outfile, "\n--- %s Simulation Trace (Hyperperiod: %d, resumed at t=%d) ---\n", policy_name(options->policy), hyperperiod, checkpoint->time);
+    fprintf(outfile, "Time | Event%-40s | Run Job(L,Q)| Ready Queue (JobId:Laxity)\n", "");
+    fprintf(outfile, "-----|--------------------------------------------|--------------|--------------------------\n");
+
+    SimulationState state;
+    init_simulation_state(&state, options, counters);
+    restore_checkpoint(&state, checkpoint, jobs_arr, job_count);
+    TraceWriter writer;
+    if (trace_writer_start(&writer, outfile, !options->quiet_misses)) state.trace = &writer;
+
+    advance_mllf_simulation(&state, hyperperiod, jobs_arr, job_count, NULL);
+
+    if (state.trace != NULL) trace_writer_stop(&writer);
     fprintf(outfile, "-----|--------------------------------------------|--------------|--------------------------\n");
+    return checkpoint->time;
+}
+
+
+// --- Checkpointing / Incremental Re-simulation ---
+void save_checkpoint(CheckpointStore* store, const SimulationState* state, const Job jobs_arr[], int job_count) {
+    if (store->count >= store->capacity) {
+        int new_capacity = (store->capacity == 0) ? 8 : store->capacity * 2;
+        SimulationCheckpoint* temp = realloc(store->entries, new_capacity * sizeof(SimulationCheckpoint));
+        if (!temp) { fprintf(stderr, "Warning: Failed realloc for checkpoint at t=%d, skipping.\n", state->current_time); return; }
+        store->entries = temp;
+        store->capacity = new_capacity;
+    }
+    SimulationCheckpoint* cp = &store->entries[store->count];
+    cp->jobs = malloc(job_count * sizeof(Job));
+    if (!cp->jobs) { fprintf(stderr, "Warning: Failed malloc for checkpoint at t=%d, skipping.\n", state->current_time); return; }
+    memcpy(cp->jobs, jobs_arr, job_count * sizeof(Job));
+
+    cp->time = state->current_time;
+    cp->ready_queue_size = state->ready_queue_size;
+    for (int i = 0; i < state->ready_queue_size; ++i) cp->ready_queue_idx[i] = (int)(state->ready_queue[i] - jobs_arr);
+    cp->running_job_idx = (state->running_job == NULL) ? -1 : (int)(state->running_job - jobs_arr);
+    cp->last_running_job_id = state->last_running_job_id;
+    cp->current_job_quantum_remaining = state->current_job_quantum_remaining;
+    cp->overhead_remaining = state->overhead_remaining;
+    cp->speed_level = state->speed_level;
+    memcpy(cp->task_share, state->task_share, sizeof(cp->task_share));
+    cp->counters = *(state->counters);
+    store->count++;
+}
+
+// Checkpoints are stored in time order, so scan from the back
+const SimulationCheckpoint* find_checkpoint_at_or_before(const CheckpointStore* store, int time) {
+    for (int i = store->count - 1; i >= 0; --i) {
+        if (store->entries[i].time <= time) return &store->entries[i];
+    }
+    return NULL;
+}
+
+// Jobs that had not arrived at the checkpoint keep their (possibly modified) freshly generated values;
+// everything else is taken from the snapshot, which is valid because it is unaffected by the change.
+void restore_checkpoint(SimulationState* state, const SimulationCheckpoint* checkpoint, Job jobs_arr[], int job_count) {
+    for (int i = 0; i < job_count; ++i) {
+        if (checkpoint->jobs[i].status != NOT_ARRIVED) jobs_arr[i] = checkpoint->jobs[i];
+    }
+    state->current_time = checkpoint->time;
+    state->ready_queue_size = checkpoint->ready_queue_size;
+    for (int i = 0; i < checkpoint->ready_queue_size; ++i) state->ready_queue[i] = &jobs_arr[checkpoint->ready_queue_idx[i]];
+    state->running_job = (checkpoint->running_job_idx == -1) ? NULL : &jobs_arr[checkpoint->running_job_idx];
+    state->last_running_job_id = checkpoint->last_running_job_id;
+    state->current_job_quantum_remaining = checkpoint->current_job_quantum_remaining;
+    state->overhead_remaining = checkpoint->overhead_remaining;
+    state->speed_level = checkpoint->speed_level;
+    memcpy(state->task_share, checkpoint->task_share, sizeof(state->task_share));
+    *(state->counters) = checkpoint->counters;
+}
+
+void free_checkpoints(CheckpointStore* store) {
+    for (int i = 0; i < store->count; ++i) free(store->entries[i].jobs);
+    free(store->entries);
+    store->entries = NULL;
+    store->count = store->capacity = 0;
+}
+
+// Earliest tick at which the modified job set can make the schedule differ from the original one.
+// WCET/AET of a job are not read before it arrives, so such changes only matter from its arrival on.
+// Deadlines of NOT_ARRIVED jobs take part in Tmin selection from time 0, as does a changed job set.
+// Precise Tmin mode and the DVFS slack check also read the WCET of NOT_ARRIVED jobs, so a WCET change
+// matters from time 0 too.
+int find_divergence_time(const Job old_jobs[], int old_count, const Job new_jobs[], int new_count, const SimulationOptions* options) {
+    if (old_count != new_count) return 0;
+    int divergence = INT_MAX;
+    for (int i = 0; i < new_count; ++i) {
+        const Job* o = &old_jobs[i]; const Job* n = &new_jobs[i];
+        if (o->task_id != n->task_id || o->arrival_time != n->arrival_time || o->absolute_deadline != n->absolute_deadline) return 0;
+        if (o->wcet != n->wcet && (options->precise_tmin || options->frequency_level_count > 0)) return 0;
+        if (o->wcet != n->wcet || o->aet != n->aet) {
+            if (n->arrival_time < divergence) divergence = n->arrival_time;
+        }
+    }
+    return divergence;
+}
+
+void run_whatif_simulation(const CliOptions* cli, int whatif_index, const Job base_jobs[], int base_job_count,
+                           int base_hyperperiod, const CheckpointStore* checkpoints, ResultCache* cache, FILE* outfile) {
+    Task tasks_list[MAX_TASKS];
+    Job* jobs_list = malloc(MAX_JOBS * sizeof(Job));
+    if (!jobs_list) { fprintf(stderr, "Error: Failed malloc for what-if run %d.\n", whatif_index + 1); return; }
+    int task_count = 0, job_count = 0, hyperperiod = 0;
+    const char* task_filename = cli->whatif_task_filenames[whatif_index];
+    const char* aet_filename = cli->whatif_aet_filenames[whatif_index];
+
+    printf("\n=== What-If Run %d: %s / %s ===\n", whatif_index + 1, task_filename, aet_filename);
+    if (load_job_set(task_filename, aet_filename, tasks_list, &task_count, jobs_list, &job_count, &hyperperiod) <= 0) {
+        fprintf(stderr, "Error: Skipping what-if run %d.\n", whatif_index + 1); free(jobs_list); return;
+    }
+
+    int divergence = (hyperperiod == base_hyperperiod) ? find_divergence_time(base_jobs, base_job_count, jobs_list, job_count, &cli->sim) : 0;
+    fprintf(outfile, "\n\n=== What-If Run %d: %s / %s ===\n", whatif_index + 1, task_filename, aet_filename);
+
+    ScheduleSummary summary;
+    uint64_t cache_key = compute_result_cache_key(tasks_list, task_count, jobs_list, job_count, hyperperiod, &cli->sim);
+    if (cache->enabled && result_cache_lookup(cache, cache_key, &summary)) {
+        print_cached_schedule_results(&summary, cache_key, outfile);
+        free(jobs_list); return;
+    }
+    if (divergence == INT_MAX) fprintf(outfile, "No parameter differences from the base run.\n");
+
+    SimulationCounters counters;
+    int resumed_at = resume_mllf_simulation(hyperperiod, jobs_list, job_count, outfile, &cli->sim, &counters,
+                                            checkpoints, divergence);
+    printf("Resumed at t=%d: reused %d of %d ticks from the base run.\n", resumed_at, resumed_at, hyperperiod);
+
+    analyze_schedule_results(jobs_list, job_count, tasks_list, task_count, &cli->sim, &counters,
+                             hyperperiod, outfile, &summary);
+    if (cache->enabled) result_cache_store(cache, cache_key, &summary);
+    free(jobs_list);
 }
 
 
 // --- Analysis Function (Mostly Unchanged, uses calculated values) ---
 void analyze_schedule_results(const Job jobs_arr[], int job_count, const Task tasks_arr[], int task_count,
-                              int context_switches, int deadline_misses, int completed_jobs, int idle_time,
-                              int hyperperiod, FILE* outfile) {
+                              const SimulationOptions* options, const SimulationCounters* counters,
+                              int hyperperiod, FILE* outfile, ScheduleSummary* summary) {
 
-    fprintf(outfile, "\n--- Simulation Analysis ---\n");
-    printf("\n--- Simulation Analysis ---\n"); // Mirror summary to console
-    fprintf(outfile, "Algorithm: MLLF\n"); printf("Algorithm: MLLF\n"); // Identify algorithm
-    fprintf(outfile, "Total time simulated: %d\n", hyperperiod); printf("Total time simulated: %d\n", hyperperiod);
-    fprintf(outfile, "Total CPU idle time: %d (%.2f%%)\n", idle_time, hyperperiod > 0 ? (double)idle_time * 100.0 / hyperperiod : 0.0); printf("Total CPU idle time: %d (%.2f%%)\n", idle_time, hyperperiod > 0 ? (double)idle_time * 100.0 / hyperperiod : 0.0);
-    fprintf(outfile, "Total jobs generated: %d\n", job_count); printf("Total jobs generated: %d\n", job_count);
-    fprintf(outfile, "Total jobs completed: %d\n", completed_jobs); printf("Total jobs completed: %d\n", completed_jobs);
-    fprintf(outfile, "Total deadline misses: %d\n", deadline_misses); printf("Total deadline misses: %d\n", deadline_misses);
-    fprintf(outfile, "Total context switches: %d\n", context_switches); printf("Total context switches: %d\n", context_switches);
-    // fprintf(outfile, "Cache Impact Points (proxy): %d\n", context_switches); printf("Cache Impact Points (proxy): %d\n", context_switches);
-
-    double total_turnaround = 0, total_waiting = 0, total_response = 0;
-    int jobs_for_avg = 0;
-    int* task_response_times[MAX_TASKS];
-    int task_response_counts[MAX_TASKS] = {0};
-    int task_response_alloc_size[MAX_TASKS] = {0};
-    for (int i = 0; i < task_count; ++i) task_response_times[i] = NULL;
+    init_schedule_summary(summary, job_count, task_count, options, counters, hyperperiod);
+    print_summary_counters(summary, outfile);
 
     fprintf(outfile, "\n--- Per-Job Analysis (Completed Jobs) ---\n");
     fprintf(outfile, "JobID | Task(Inst) | Arriv | AET | WCET| Finish | Turnaround | Waiting | Response\n");
@@ -777,101 +1616,1109 @@ void analyze_schedule_results(const Job jobs_arr[], int job_count, const Task ta
     for (int i = 0; i < job_count; ++i) {
         const Job* job = &jobs_arr[i]; // Use const pointer
         if (job->status == COMPLETED) {
-            // Basic sanity check
-            if (job->finish_time < job->arrival_time || job->aet < 0) {
+            int turnaround, waiting, response;
+            if (!completed_job_times(job, &turnaround, &waiting, &response)) {
                  fprintf(outfile, "Warning: Job J%d timing/AET inconsistent...\n", job->job_id); continue;
             }
-             // Response time calculation needs care if first_start_time wasn't recorded correctly
-             if (job->first_start_time < job->arrival_time) {
-                  // fprintf(outfile, "Warning: Job J%d first_start_time (%d) < arrival_time (%d).\n", job->job_id, job->first_start_time, job->arrival_time);
-                  // Set response to 0 or handle as error? Let's assume 0 if start < arrival
-                  // response = 0;
-             }
-
-            int turnaround = job->finish_time - job->arrival_time;
-            int waiting = turnaround - job->aet; // Use actual execution time
-            if (waiting < 0) waiting = 0; // Waiting time cannot be negative due to rounding etc.
-            int response = (job->first_start_time >= job->arrival_time) ? (job->first_start_time - job->arrival_time) : 0; // Ensure non-negative
-
-
-            // Update job struct directly (or use separate analysis struct)
-            // For simplicity, we update here, though it mixes simulation state with results
-            // ((Job*)job)->turnaround_time = turnaround; // Cast away const if needed
-            // ((Job*)job)->waiting_time = waiting;
-            // ((Job*)job)->response_time = response;
-
 
              fprintf(outfile, "J%-4d | T%d(%-2d)    | %5d | %3d | %3d | %6d | %10d | %7d | %8d\n",
                    job->job_id, job->task_id, job->instance_number,
                    job->arrival_time, job->aet, job->wcet, job->finish_time,
                    turnaround, waiting, response);
 
-            total_turnaround += turnaround;
-            total_waiting += waiting;
-            total_response += response;
-            jobs_for_avg++;
-
-            // Store response time for jitter
-            int tid = job->task_id;
-            if (tid >= 0 && tid < task_count) { // Bounds check
-                 if (task_response_counts[tid] >= task_response_alloc_size[tid]) {
-                    int new_size = (task_response_alloc_size[tid] == 0) ? 10 : task_response_alloc_size[tid] * 2;
-                    if (new_size > MAX_RESPONSE_TIMES_PER_TASK) new_size = MAX_RESPONSE_TIMES_PER_TASK;
-                    int* temp = realloc(task_response_times[tid], new_size * sizeof(int));
-                    if (!temp && new_size > 0) {
-                        fprintf(stderr, "Error: Failed realloc for RT analysis (Task %d, size %d).\n", tid, new_size);
-                        // Skip adding this response time if realloc fails
-                    } else {
-                        task_response_times[tid] = temp;
-                        task_response_alloc_size[tid] = new_size;
-                         if (task_response_counts[tid] < task_response_alloc_size[tid]) { // Check again after potential realloc
-                            task_response_times[tid][task_response_counts[tid]++] = response;
-                         } else {
-                             // Should not happen if realloc succeeded, but defensive check
-                             fprintf(stderr, "Error: RT analysis buffer full post-realloc (Task %d).\n", tid);
-                         }
-                    }
-                 } else {
-                     task_response_times[tid][task_response_counts[tid]++] = response;
-                 }
-            }
+            accumulate_job_statistics(summary, job->task_id, turnaround, waiting, response);
         } else if (job->status == MISSED) {
              fprintf(outfile, "J%-4d | T%d(%-2d)    | %5d | %3d | %3d | MISSED D:%-4d| ---        | ---     | ---      \n",
                    job->job_id, job->task_id, job->instance_number, job->arrival_time, job->aet, job->wcet, job->absolute_deadline);
         }
     }
 
+    print_summary_statistics(summary, outfile);
+}
+
+// Timing of a completed job; false if it fails the basic sanity check
+bool completed_job_times(const Job* job, int* turnaround, int* waiting, int* response) {
+    if (job->finish_time < job->arrival_time || job->aet < 0) return false;
+    *turnaround = job->finish_time - job->arrival_time;
+    *waiting = *turnaround - job->aet; // Use actual execution time
+    if (*waiting < 0) *waiting = 0; // Waiting time cannot be negative due to rounding etc.
+    *response = (job->first_start_time >= job->arrival_time) ? (job->first_start_time - job->arrival_time) : 0; // Ensure non-negative
+    return true;
+}
+
+// The summary analyze_schedule_results would build, without any output (for silent runs that are cached)
+void summarize_schedule(const Job jobs_arr[], int job_count, int task_count, const SimulationOptions* options,
+                        const SimulationCounters* counters, int hyperperiod, ScheduleSummary* summary) {
+    init_schedule_summary(summary, job_count, task_count, options, counters, hyperperiod);
+    for (int i = 0; i < job_count; ++i) {
+        int turnaround, waiting, response;
+        if (jobs_arr[i].status == COMPLETED && completed_job_times(&jobs_arr[i], &turnaround, &waiting, &response)) {
+            accumulate_job_statistics(summary, jobs_arr[i].task_id, turnaround, waiting, response);
+        }
+    }
+}
+
+void init_schedule_summary(ScheduleSummary* summary, int job_count, int task_count,
+                           const SimulationOptions* options, const SimulationCounters* counters, int hyperperiod) {
+    memset(summary, 0, sizeof(*summary));
+    summary->hyperperiod = hyperperiod;
+    summary->job_count = job_count;
+    summary->task_count = task_count;
+    summary->policy = options->policy;
+    summary->precise_tmin = options->precise_tmin;
+    summary->level_count = options->frequency_level_count;
+    summary->counters = *counters;
+    for (int tid = 0; tid < MAX_TASKS; ++tid) {
+        summary->task_stats[tid].min_rt = INT_MAX;
+        summary->task_stats[tid].max_rt = INT_MIN;
+    }
+}
+
+// Adds one completed job. Relative jitter compares consecutive completed instances of the same task.
+void accumulate_job_statistics(ScheduleSummary* summary, int task_id, int turnaround, int waiting, int response) {
+    summary->total_turnaround += turnaround;
+    summary->total_waiting += waiting;
+    summary->total_response += response;
+    summary->jobs_for_avg++;
+
+    if (task_id < 0 || task_id >= summary->task_count) return; // Bounds check
+    TaskResponseStats* stats = &summary->task_stats[task_id];
+    if (stats->samples > 0) {
+        int diff = abs(response - stats->last_rt); // Diff between consecutive job instances of same task
+        if (diff > stats->max_rel_jitter) stats->max_rel_jitter = diff;
+    }
+    if (response < stats->min_rt) stats->min_rt = response;
+    if (response > stats->max_rt) stats->max_rt = response;
+    stats->sum_rt += response;
+    stats->last_rt = response;
+    stats->samples++;
+}
+
+void print_summary_counters(const ScheduleSummary* summary, FILE* outfile) {
+    const SimulationCounters* counters = &summary->counters;
+    int hyperperiod = summary->hyperperiod, idle_time = counters->idle_time;
+    fprintf(outfile, "\n--- Simulation Analysis ---\n");
+    printf("\n--- Simulation Analysis ---\n"); // Mirror summary to console
+    fprintf(outfile, "Algorithm: %s%s\n", policy_name(summary->policy), summary->precise_tmin ? " (precise Tmin)" : ""); printf("Algorithm: %s%s\n", policy_name(summary->policy), summary->precise_tmin ? " (precise Tmin)" : ""); // Identify algorithm
+    fprintf(outfile, "Total time simulated: %d\n", hyperperiod); printf("Total time simulated: %d\n", hyperperiod);
+    fprintf(outfile, "Total CPU idle time: %d (%.2f%%)\n", idle_time, hyperperiod > 0 ? (double)idle_time * 100.0 / hyperperiod : 0.0); printf("Total CPU idle time: %d (%.2f%%)\n", idle_time, hyperperiod > 0 ? (double)idle_time * 100.0 / hyperperiod : 0.0);
+    fprintf(outfile, "Total jobs generated: %d\n", summary->job_count); printf("Total jobs generated: %d\n", summary->job_count);
+    fprintf(outfile, "Total jobs completed: %d\n", counters->completed_jobs); printf("Total jobs completed: %d\n", counters->completed_jobs);
+    fprintf(outfile, "Total deadline misses: %d\n", counters->deadline_misses); printf("Total deadline misses: %d\n", counters->deadline_misses);
+    fprintf(outfile, "Total context switches: %d\n", counters->context_switches); printf("Total context switches: %d\n", counters->context_switches);
+    fprintf(outfile, "Cache Impact Points (preemptions / reloads): %d / %d\n", counters->preemptions, counters->reload_events); printf("Cache Impact Points (preemptions / reloads): %d / %d\n", counters->preemptions, counters->reload_events);
+    fprintf(outfile, "Quantum expirations / ResetQ events: %d / %d\n", counters->quantum_expirations, counters->resetq_events); printf("Quantum expirations / ResetQ events: %d / %d\n", counters->quantum_expirations, counters->resetq_events);
+    fprintf(outfile, "Scheduling overhead time: %d (%.2f%%)\n", counters->overhead_time, hyperperiod > 0 ? (double)counters->overhead_time * 100.0 / hyperperiod : 0.0); printf("Scheduling overhead time: %d (%.2f%%)\n", counters->overhead_time, hyperperiod > 0 ? (double)counters->overhead_time * 100.0 / hyperperiod : 0.0);
+}
+
+void print_summary_statistics(const ScheduleSummary* summary, FILE* outfile) {
+    int jobs_for_avg = summary->jobs_for_avg;
     fprintf(outfile, "\n--- Average Performance Metrics (for Completed Jobs) ---\n");
     printf("\n--- Average Performance Metrics (for Completed Jobs) ---\n");
     if (jobs_for_avg > 0) {
-        fprintf(outfile, "Average Turnaround Time: %.2f\n", total_turnaround / jobs_for_avg); printf("Average Turnaround Time: %.2f\n", total_turnaround / jobs_for_avg);
-        fprintf(outfile, "Average Waiting Time:    %.2f\n", total_waiting / jobs_for_avg); printf("Average Waiting Time:    %.2f\n", total_waiting / jobs_for_avg);
-        fprintf(outfile, "Average Response Time:   %.2f\n", total_response / jobs_for_avg); printf("Average Response Time:   %.2f\n", total_response / jobs_for_avg);
+        fprintf(outfile, "Average Turnaround Time: %.2f\n", summary->total_turnaround / jobs_for_avg); printf("Average Turnaround Time: %.2f\n", summary->total_turnaround / jobs_for_avg);
+        fprintf(outfile, "Average Waiting Time:    %.2f\n", summary->total_waiting / jobs_for_avg); printf("Average Waiting Time:    %.2f\n", summary->total_waiting / jobs_for_avg);
+        fprintf(outfile, "Average Response Time:   %.2f\n", summary->total_response / jobs_for_avg); printf("Average Response Time:   %.2f\n", summary->total_response / jobs_for_avg);
     } else { fprintf(outfile, "No jobs completed successfully.\n"); printf("No jobs completed successfully.\n"); }
 
     fprintf(outfile, "\n--- Response Time Jitter Analysis (for Completed Jobs) ---\n");
     printf("\n--- Response Time Jitter Analysis (for Completed Jobs) ---\n");
-    for (int tid = 0; tid < task_count; ++tid) {
-        int count = task_response_counts[tid];
-        if (count > 0 && task_response_times[tid] != NULL) {
-            int min_rt = INT_MAX, max_rt = INT_MIN, max_rel_jitter = 0;
-             int sum_rt = 0; // For average per task
-            for (int i = 0; i < count; ++i) {
-                int rt = task_response_times[tid][i];
-                sum_rt += rt;
-                if (rt < min_rt) min_rt = rt; if (rt > max_rt) max_rt = rt;
-                if (i > 0) {
-                    int diff = abs(rt - task_response_times[tid][i-1]); // Diff between consecutive job instances of same task
-                    if (diff > max_rel_jitter) max_rel_jitter = diff;
-                }
-            }
-            int abs_jitter = max_rt - min_rt;
-            double avg_rt = (double)sum_rt / count;
-            fprintf(outfile, "Task %d: Avg RT=%.2f, Min RT=%d, Max RT=%d, Abs Jitter=%d, Max Rel Jitter=%d (%d samples)\n", tid, avg_rt, min_rt, max_rt, abs_jitter, max_rel_jitter, count);
-            printf("Task %d: Avg RT=%.2f, Min RT=%d, Max RT=%d, Abs Jitter=%d, Max Rel Jitter=%d (%d samples)\n", tid, avg_rt, min_rt, max_rt, abs_jitter, max_rel_jitter, count);
+    for (int tid = 0; tid < summary->task_count; ++tid) {
+        const TaskResponseStats* stats = &summary->task_stats[tid];
+        int count = stats->samples;
+        if (count > 0) {
+            int abs_jitter = stats->max_rt - stats->min_rt;
+            double avg_rt = (double)stats->sum_rt / count;
+            fprintf(outfile, "Task %d: Avg RT=%.2f, Min RT=%d, Max RT=%d, Abs Jitter=%d, Max Rel Jitter=%d (%d samples)\n", tid, avg_rt, stats->min_rt, stats->max_rt, abs_jitter, stats->max_rel_jitter, count);
+            printf("Task %d: Avg RT=%.2f, Min RT=%d, Max RT=%d, Abs Jitter=%d, Max Rel Jitter=%d (%d samples)\n", tid, avg_rt, stats->min_rt, stats->max_rt, abs_jitter, stats->max_rel_jitter, count);
         } else { fprintf(outfile, "Task %d: No completed jobs or response times recorded.\n", tid); printf("Task %d: No completed jobs or response times recorded.\n", tid); }
-        free(task_response_times[tid]); // Free memory allocated by realloc
     }
      fprintf(outfile, "--------------------------------------------------------\n");
      printf("--------------------------------------------------------\n");
-}
\ No newline at end of file
+}
+
+
+// --- Persistent Result Cache ---
+// Entries are text files named by a 64-bit FNV-1a hash of everything that determines the result:
+// cache version, policy and overhead options, task parameters and the AET sequence. The hash is computed from parsed values,
+// so reformatting an input file does not cause a miss. Writes go to a temp file and are renamed into place.
+
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t len) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < len; ++i) { hash ^= bytes[i]; hash *= 1099511628211ULL; } // FNV-1a 64-bit prime
+    return hash;
+}
+
+// Hashes ints as 4 little-endian bytes so keys do not depend on host byte order
+uint64_t hash_int(uint64_t hash, int value) {
+    uint32_t v = (uint32_t)value;
+    unsigned char bytes[4] = { (unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+    return hash_bytes(hash, bytes, sizeof(bytes));
+}
+
+uint64_t compute_result_cache_key(const Task tasks_arr[], int task_count, const Job jobs_arr[], int job_count, int hyperperiod,
+                                  const SimulationOptions* options) {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a 64-bit offset basis
+    hash = hash_int(hash, RESULT_CACHE_VERSION);
+    hash = hash_int(hash, (int)options->policy);
+    hash = hash_int(hash, options->switch_cost); hash = hash_int(hash, options->preempt_cost); hash = hash_int(hash, options->reload_penalty);
+    hash = hash_int(hash, options->precise_tmin ? 1 : 0);
+    for (int i = 0; i < options->frequency_level_count; ++i) hash = hash_int(hash, options->frequency_levels[i]); // No levels: key unchanged
+    hash = hash_int(hash, hyperperiod);
+    hash = hash_int(hash, task_count);
+    for (int i = 0; i < task_count; ++i) {
+        hash = hash_int(hash, tasks_arr[i].arrival_time); hash = hash_int(hash, tasks_arr[i].period);
+        hash = hash_int(hash, tasks_arr[i].wcet); hash = hash_int(hash, tasks_arr[i].deadline);
+    }
+    hash = hash_int(hash, job_count);
+    for (int i = 0; i < job_count; ++i) hash = hash_int(hash, jobs_arr[i].aet);
+    return hash;
+}
+
+void result_cache_open(ResultCache* cache, const char* dir) {
+    memset(cache, 0, sizeof(*cache));
+    strncpy(cache->dir, dir, MAX_FILENAME_LEN - 1);
+    struct stat st;
+    if (stat(dir, &st) != 0 && mkdir(dir, 0755) != 0) {
+        perror("Warning: Cannot create result cache directory, caching disabled");
+        return;
+    }
+    cache->enabled = true;
+}
+
+void result_cache_entry_path(const ResultCache* cache, uint64_t key, char* path, size_t path_size) {
+    snprintf(path, path_size, "%s/%016llx.mllf", cache->dir, (unsigned long long)key);
+}
+
+bool result_cache_lookup(ResultCache* cache, uint64_t key, ScheduleSummary* summary) {
+    char path[MAX_PATH_LEN];
+    result_cache_entry_path(cache, key, path, sizeof(path));
+    cache->lookups++;
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char magic[32]; int version = 0; unsigned long long stored_key = 0;
+    bool ok = fscanf(file, "%31s %d %llx", magic, &version, &stored_key) == 3
+              && strcmp(magic, RESULT_CACHE_MAGIC) == 0 && version == RESULT_CACHE_VERSION && stored_key == key;
+    ScheduleSummary entry;
+    memset(&entry, 0, sizeof(entry));
+    int policy = 0, precise_tmin = 0;
+    SimulationCounters* counters = &entry.counters;
+    ok = ok && fscanf(file, "%d %d %d %d %d %d", &entry.hyperperiod, &entry.job_count, &entry.task_count, &policy, &precise_tmin, &entry.jobs_for_avg) == 6
+            && fscanf(file, "%d %d %d %d %d %d %d %d %d", &counters->context_switches, &counters->deadline_misses, &counters->completed_jobs,
+                      &counters->idle_time, &counters->preemptions, &counters->reload_events, &counters->overhead_time,
+                      &counters->quantum_expirations, &counters->resetq_events) == 9
+            && fscanf(file, "%lf %lf %lf", &entry.total_turnaround, &entry.total_waiting, &entry.total_response) == 3
+            && entry.task_count >= 0 && entry.task_count <= MAX_TASKS;
+    int level_count = 0;
+    ok = ok && fscanf(file, "%d", &level_count) == 1 && level_count >= 0 && level_count <= MAX_FREQUENCY_LEVELS;
+    for (int l = 0; ok && l < level_count; ++l) ok = fscanf(file, "%d", &counters->level_ticks[l]) == 1;
+    for (int tid = 0; ok && tid < entry.task_count; ++tid) {
+        TaskResponseStats* stats = &entry.task_stats[tid];
+        ok = fscanf(file, "%d %lld %d %d %d %d", &stats->samples, &stats->sum_rt, &stats->min_rt,
+                    &stats->max_rt, &stats->max_rel_jitter, &stats->last_rt) == 6;
+    }
+    fclose(file);
+    if (!ok) { fprintf(stderr, "Warning: Ignoring stale or corrupt cache entry %s.\n", path); return false; }
+    entry.policy = (SchedulingPolicy)policy;
+    entry.precise_tmin = (precise_tmin != 0);
+    entry.level_count = level_count;
+
+    *summary = entry;
+    cache->hits++;
+    return true;
+}
+
+void result_cache_store(const ResultCache* cache, uint64_t key, const ScheduleSummary* summary) {
+    char path[MAX_PATH_LEN], temp_path[MAX_PATH_LEN + 32];
+    result_cache_entry_path(cache, key, path, sizeof(path));
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp%ld", path, (long)getpid());
+    FILE* file = fopen(temp_path, "w");
+    if (!file) { perror("Warning: Cannot write result cache entry"); return; }
+
+    fprintf(file, "%s %d %016llx\n", RESULT_CACHE_MAGIC, RESULT_CACHE_VERSION, (unsigned long long)key);
+    const SimulationCounters* counters = &summary->counters;
+    fprintf(file, "%d %d %d %d %d %d\n", summary->hyperperiod, summary->job_count, summary->task_count,
+            (int)summary->policy, summary->precise_tmin ? 1 : 0, summary->jobs_for_avg);
+    fprintf(file, "%d %d %d %d %d %d %d %d %d\n", counters->context_switches, counters->deadline_misses, counters->completed_jobs,
+            counters->idle_time, counters->preemptions, counters->reload_events, counters->overhead_time,
+            counters->quantum_expirations, counters->resetq_events);
+    fprintf(file, "%.17g %.17g %.17g\n", summary->total_turnaround, summary->total_waiting, summary->total_response);
+    fprintf(file, "%d", summary->level_count); // DVFS busy ticks per level, for the energy report on a hit
+    for (int l = 0; l < summary->level_count; ++l) fprintf(file, " %d", counters->level_ticks[l]);
+    fprintf(file, "\n");
+    for (int tid = 0; tid < summary->task_count; ++tid) {
+        const TaskResponseStats* stats = &summary->task_stats[tid];
+        fprintf(file, "%d %lld %d %d %d %d\n", stats->samples, stats->sum_rt, stats->min_rt, stats->max_rt, stats->max_rel_jitter, stats->last_rt);
+    }
+    if (fclose(file) != 0 || rename(temp_path, path) != 0) {
+        perror("Warning: Cannot finalize result cache entry");
+        remove(temp_path);
+    }
+}
+
+// Prints this run's hits and updates the cumulative counters kept in <cache dir>/stats
+void result_cache_report(const ResultCache* cache, FILE* outfile) {
+    char path[MAX_PATH_LEN];
+    snprintf(path, sizeof(path), "%s/stats", cache->dir);
+    long long total_lookups = 0, total_hits = 0;
+    FILE* file = fopen(path, "r");
+    if (file) {
+        if (fscanf(file, "%lld %lld", &total_lookups, &total_hits) != 2) total_lookups = total_hits = 0;
+        fclose(file);
+    }
+    total_lookups += cache->lookups; total_hits += cache->hits;
+    file = fopen(path, "w");
+    if (file) { fprintf(file, "%lld %lld\n", total_lookups, total_hits); fclose(file); }
+
+    double run_rate = cache->lookups > 0 ? (double)cache->hits * 100.0 / cache->lookups : 0.0;
+    double total_rate = total_lookups > 0 ? (double)total_hits * 100.0 / total_lookups : 0.0;
+    fprintf(outfile, "\nResult cache: %d/%d hits (%.1f%%) this run, %lld/%lld (%.1f%%) overall\n",
+            cache->hits, cache->lookups, run_rate, total_hits, total_lookups, total_rate);
+    printf("\nResult cache: %d/%d hits (%.1f%%) this run, %lld/%lld (%.1f%%) overall\n",
+           cache->hits, cache->lookups, run_rate, total_hits, total_lookups, total_rate);
+}
+
+void print_cached_schedule_results(const ScheduleSummary* summary, uint64_t key, FILE* outfile) {
+    fprintf(outfile, "\n--- %s Simulation skipped: result cache hit (key %016llx), no trace or per-job table ---\n", policy_name(summary->policy), (unsigned long long)key);
+    printf("Result cache hit (key %016llx), simulation skipped.\n", (unsigned long long)key);
+    print_summary_counters(summary, outfile);
+    print_summary_statistics(summary, outfile);
+}
+
+
+// --- Mode Comparisons ---
+// Precise Tmin and DVFS runs are compared against a silent run of the same jobs without the mode. That
+// run is an ordinary simulation of other options, so it is looked up and stored under its own cache key.
+bool run_baseline_simulation(const Task tasks_arr[], int task_count, const Job pristine_jobs[], int job_count, int hyperperiod,
+                             const SimulationOptions* options, ResultCache* cache, SimulationCounters* counters) {
+    uint64_t key = compute_result_cache_key(tasks_arr, task_count, pristine_jobs, job_count, hyperperiod, options);
+    ScheduleSummary summary;
+    if (cache->enabled && result_cache_lookup(cache, key, &summary)) {
+        *counters = summary.counters;
+        return true;
+    }
+    Job* jobs = malloc(job_count * sizeof(Job));
+    if (!jobs) { fprintf(stderr, "Error: Failed malloc for baseline run.\n"); return false; }
+    memcpy(jobs, pristine_jobs, job_count * sizeof(Job));
+    run_mllf_simulation(hyperperiod, jobs, job_count, NULL, options, counters, NULL);
+    if (cache->enabled) {
+        summarize_schedule(jobs, job_count, task_count, options, counters, hyperperiod, &summary);
+        result_cache_store(cache, key, &summary);
+    }
+    free(jobs);
+    return true;
+}
+
+void report_mode_comparisons(const Task tasks_arr[], int task_count, const Job pristine_jobs[], int job_count, int hyperperiod,
+                             const SimulationOptions* options, ResultCache* cache, const SimulationCounters* counters, FILE* outfile) {
+    SimulationCounters baseline;
+    if (options->precise_tmin) {
+        SimulationOptions simplified_options = *options;
+        simplified_options.precise_tmin = false;
+        if (run_baseline_simulation(tasks_arr, task_count, pristine_jobs, job_count, hyperperiod, &simplified_options, cache, &baseline)) {
+            report_tmin_mode_comparison(&baseline, counters, outfile);
+        }
+    }
+    if (options->frequency_level_count > 0) {
+        SimulationOptions full_speed_options = *options;
+        full_speed_options.frequency_level_count = 0;
+        if (run_baseline_simulation(tasks_arr, task_count, pristine_jobs, job_count, hyperperiod, &full_speed_options, cache, &baseline)) {
+            report_dvfs_energy(hyperperiod, options, &baseline, counters, outfile);
+        }
+    }
+}
+
+void report_tmin_mode_comparison(const SimulationCounters* simplified, const SimulationCounters* precise, FILE* outfile) {
+    const char* names[] = { "Preemptions", "Context switches", "Quantum expirations", "ResetQ events", "Deadline misses" };
+    int precise_values[] = { precise->preemptions, precise->context_switches, precise->quantum_expirations, precise->resetq_events, precise->deadline_misses };
+    int simplified_values[] = { simplified->preemptions, simplified->context_switches, simplified->quantum_expirations, simplified->resetq_events, simplified->deadline_misses };
+
+    fprintf(outfile, "\n--- Precise vs Simplified Tmin Selection ---\n"); printf("\n--- Precise vs Simplified Tmin Selection ---\n");
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); ++i) {
+        int reduction = simplified_values[i] - precise_values[i];
+        double reduction_pct = simplified_values[i] > 0 ? (double)reduction * 100.0 / simplified_values[i] : 0.0;
+        fprintf(outfile, "%-20s: %d precise vs %d simplified (reduction %d, %.1f%%)\n", names[i], precise_values[i], simplified_values[i], reduction, reduction_pct);
+        printf("%-20s: %d precise vs %d simplified (reduction %d, %.1f%%)\n", names[i], precise_values[i], simplified_values[i], reduction, reduction_pct);
+    }
+}
+
+
+// Parses "40,60,80,100". Levels must be ascending within 1..100 and include full speed.
+int parse_frequency_levels(const char* list, SimulationOptions* options) {
+    options->frequency_level_count = 0;
+    const char* cursor = list;
+    while (*cursor != '\0') {
+        char* end;
+        long level = strtol(cursor, &end, 10);
+        if (end == cursor || level < 1 || level > 100 || (*end != ',' && *end != '\0')) {
+            fprintf(stderr, "Error: Invalid frequency level list %s (expected percentages such as 40,60,80,100).\n", list); return 0;
+        }
+        if (options->frequency_level_count >= MAX_FREQUENCY_LEVELS) { fprintf(stderr, "Error: At most %d frequency levels supported.\n", MAX_FREQUENCY_LEVELS); return 0; }
+        if (options->frequency_level_count > 0 && level <= options->frequency_levels[options->frequency_level_count - 1]) {
+            fprintf(stderr, "Error: Frequency levels must be strictly ascending.\n"); return 0;
+        }
+        options->frequency_levels[options->frequency_level_count++] = (int)level;
+        cursor = (*end == ',') ? end + 1 : end;
+    }
+    if (options->frequency_level_count == 0 || options->frequency_levels[options->frequency_level_count - 1] != 100) {
+        fprintf(stderr, "Error: Frequency levels must end with 100 (full speed).\n"); return 0;
+    }
+    return 1;
+}
+
+// Power relative to running at full speed (dynamic power scales with f^3 when voltage follows frequency)
+double power_at_speed(const SimulationOptions* options, int speed_percent) {
+    double f = speed_percent / 100.0;
+    return options->static_power + (1.0 - options->static_power) * f * f * f;
+}
+
+void report_dvfs_energy(int hyperperiod, const SimulationOptions* options, const SimulationCounters* full_speed,
+                        const SimulationCounters* scaled, FILE* outfile) {
+    // Energy in units of one full-speed busy tick; idle ticks draw static power in both runs
+    double scaled_energy = scaled->idle_time * options->static_power;
+    for (int l = 0; l < options->frequency_level_count; ++l) scaled_energy += scaled->level_ticks[l] * power_at_speed(options, options->frequency_levels[l]);
+    double full_speed_energy = (hyperperiod - full_speed->idle_time) + full_speed->idle_time * options->static_power;
+    double saving = full_speed_energy - scaled_energy;
+    double saving_pct = full_speed_energy > 0 ? saving * 100.0 / full_speed_energy : 0.0;
+
+    fprintf(outfile, "\n--- DVFS Slack Reclamation (static power %.2f) ---\n", options->static_power);
+    printf("\n--- DVFS Slack Reclamation (static power %.2f) ---\n", options->static_power);
+    fprintf(outfile, "Energy              : %.1f scaled vs %.1f full speed (saving %.1f, %.1f%%)\n", scaled_energy, full_speed_energy, saving, saving_pct);
+    printf("Energy              : %.1f scaled vs %.1f full speed (saving %.1f, %.1f%%)\n", scaled_energy, full_speed_energy, saving, saving_pct);
+    fprintf(outfile, "Deadline misses     : %d scaled vs %d full speed\n", scaled->deadline_misses, full_speed->deadline_misses);
+    printf("Deadline misses     : %d scaled vs %d full speed\n", scaled->deadline_misses, full_speed->deadline_misses);
+    if (scaled->deadline_misses > full_speed->deadline_misses) { // Speed selection must never cost a deadline
+        fprintf(stderr, "Warning: DVFS added %d deadline miss(es) over the full-speed run.\n", scaled->deadline_misses - full_speed->deadline_misses);
+    }
+    fprintf(outfile, "Context switches    : %d scaled vs %d full speed\n", scaled->context_switches, full_speed->context_switches);
+    printf("Context switches    : %d scaled vs %d full speed\n", scaled->context_switches, full_speed->context_switches);
+    fprintf(outfile, "Busy ticks per level:"); printf("Busy ticks per level:");
+    for (int l = 0; l < options->frequency_level_count; ++l) {
+        fprintf(outfile, " %d%%=%d", options->frequency_levels[l], scaled->level_ticks[l]);
+        printf(" %d%%=%d", options->frequency_levels[l], scaled->level_ticks[l]);
+    }
+    fprintf(outfile, " (idle %d)\n", scaled->idle_time); printf(" (idle %d)\n", scaled->idle_time);
+}
+
+
+// --- Breakdown Utilization / WCET Sensitivity ---
+// Every probe is a full silent simulation with AET = WCET, so "schedulable" means no deadline miss
+// within the hyperperiod. Probes of one search round are independent and run on a worker pool.
+
+int scaled_wcet(int wcet, double factor) {
+    int scaled = (int)ceil(wcet * factor - 1e-9); // Round up: a scaled WCET must never be optimistic
+    return (scaled < 1) ? 1 : scaled;
+}
+
+// Density of the task set with every WCET scaled as the probes scale it
+double scaled_density(const Task tasks_arr[], int task_count, double factor) {
+    double density = 0.0;
+    for (int i = 0; i < task_count; ++i) {
+        int window = (tasks_arr[i].deadline < tasks_arr[i].period) ? tasks_arr[i].deadline : tasks_arr[i].period;
+        density += (double)scaled_wcet(tasks_arr[i].wcet, factor) / window;
+    }
+    return density;
+}
+
+// Largest factor whose rounded-up WCETs still pass the density test, or 0 if none does. Rounding only
+// adds work, so it is at most the unrounded bound, and the scaled WCETs only step at factors k / WCET:
+// walk those steps down from the unrounded bound until the test passes.
+double find_density_factor(const Task tasks_arr[], int task_count, double unrounded_bound) {
+    double factor = unrounded_bound;
+    while (factor > 0.0 && scaled_density(tasks_arr, task_count, factor) > 1.0 + 1e-9) {
+        double next = 0.0; // Largest step below factor
+        for (int i = 0; i < task_count; ++i) {
+            double step = (double)(scaled_wcet(tasks_arr[i].wcet, factor) - 1) / tasks_arr[i].wcet;
+            if (step < factor && step > next) next = step;
+        }
+        factor = next;
+    }
+    return factor;
+}
+
+void probe_schedulable(SensitivityProbe* probe) {
+    Job* jobs = malloc(probe->job_count * sizeof(Job));
+    if (!jobs) { fprintf(stderr, "Error: Failed malloc for sensitivity probe.\n"); probe->schedulable = false; return; }
+    memcpy(jobs, probe->template_jobs, probe->job_count * sizeof(Job));
+    for (int i = 0; i < probe->job_count; ++i) {
+        int wcet = probe->wcet_per_task[jobs[i].task_id];
+        jobs[i].wcet = jobs[i].remaining_wcet = wcet;
+        jobs[i].aet = jobs[i].remaining_aet = wcet;
+    }
+
+    // Simulate until the last deadline so every job is judged, not only those due within the hyperperiod
+    int horizon = probe->hyperperiod;
+    for (int i = 0; i < probe->job_count; ++i) if (jobs[i].absolute_deadline > horizon) horizon = jobs[i].absolute_deadline;
+
+    SimulationCounters counters;
+    run_mllf_simulation(horizon, jobs, probe->job_count, NULL, probe->options, &counters, NULL);
+    probe->schedulable = (counters.deadline_misses == 0);
+    free(jobs);
+}
+
+void* probe_worker_main(void* arg) {
+    ProbeWorker* worker = (ProbeWorker*)arg;
+    for (int i = worker->first; i < worker->probe_count; i += worker->stride) {
+        probe_schedulable(&worker->probes[i]);
+    }
+    return NULL;
+}
+
+void run_probe_batch(SensitivityProbe probes[], int probe_count, int thread_count) {
+    pthread_t threads[MAX_PROBE_THREADS];
+    ProbeWorker workers[MAX_PROBE_THREADS];
+    bool started[MAX_PROBE_THREADS] = {false};
+    if (probe_count <= 0) return;
+    int worker_count = (probe_count < thread_count) ? probe_count : thread_count;
+    if (worker_count < 1) worker_count = 1;
+
+    for (int t = 0; t < worker_count; ++t) {
+        workers[t].probes = probes; workers[t].probe_count = probe_count;
+        workers[t].first = t; workers[t].stride = worker_count;
+        // Worker 0 runs on the calling thread; fall back to inline execution if a thread cannot be created
+        if (t > 0 && pthread_create(&threads[t], NULL, probe_worker_main, &workers[t]) == 0) started[t] = true;
+    }
+    probe_worker_main(&workers[0]);
+    for (int t = 1; t < worker_count; ++t) {
+        if (started[t]) pthread_join(threads[t], NULL);
+        else probe_worker_main(&workers[t]);
+    }
+}
+
+// Largest uniform WCET scaling factor without misses. The density test on the rounded WCETs (sufficient
+// for LLF-class schedulers on one core) and the utilization test (necessary) bracket the search before probing.
+double find_breakdown_factor(const Task tasks_arr[], int task_count, const Job template_jobs[], int job_count, int hyperperiod,
+                             const SimulationOptions* options, int thread_count,
+                             double* sufficient_bound, double* necessary_bound, int* probes_run) {
+    double utilization = 0.0, density = 0.0, wcet_limit = INFINITY;
+    for (int i = 0; i < task_count; ++i) {
+        int window = (tasks_arr[i].deadline < tasks_arr[i].period) ? tasks_arr[i].deadline : tasks_arr[i].period;
+        utilization += (double)tasks_arr[i].wcet / tasks_arr[i].period;
+        density += (double)tasks_arr[i].wcet / window;
+        double limit = (double)tasks_arr[i].deadline / tasks_arr[i].wcet; // A job can never exceed its own deadline
+        if (limit < wcet_limit) wcet_limit = limit;
+    }
+    *sufficient_bound = find_density_factor(tasks_arr, task_count, 1.0 / density);
+    *necessary_bound = (1.0 / utilization < wcet_limit) ? 1.0 / utilization : wcet_limit;
+
+    SensitivityProbe probes[MAX_PROBE_THREADS];
+    double factors[MAX_PROBE_THREADS];
+    for (int k = 0; k < MAX_PROBE_THREADS; ++k) {
+        probes[k].template_jobs = template_jobs; probes[k].job_count = job_count; probes[k].hyperperiod = hyperperiod;
+        probes[k].options = options;
+    }
+
+    // Round 0: probe both analytic bounds
+    factors[0] = *sufficient_bound; factors[1] = *necessary_bound;
+    for (int k = 0; k < 2; ++k) for (int i = 0; i < task_count; ++i) probes[k].wcet_per_task[i] = scaled_wcet(tasks_arr[i].wcet, factors[k]);
+    run_probe_batch(probes, 2, thread_count);
+    *probes_run += 2;
+
+    double lo = 0.0, hi = factors[1];
+    if (probes[0].schedulable) lo = factors[0]; else hi = factors[0];
+    if (probes[0].schedulable && probes[1].schedulable) {
+        // The finite simulation horizon can tolerate more than the utilization bound; grow until a miss
+        lo = hi;
+        for (int d = 0; d < MAX_FACTOR_DOUBLINGS; ++d) {
+            if (lo >= wcet_limit) return wcet_limit; // Any larger factor pushes some WCET past its deadline
+            hi = (lo * 2.0 < wcet_limit) ? lo * 2.0 : wcet_limit;
+            for (int i = 0; i < task_count; ++i) probes[0].wcet_per_task[i] = scaled_wcet(tasks_arr[i].wcet, hi);
+            run_probe_batch(probes, 1, 1);
+            (*probes_run)++;
+            if (!probes[0].schedulable) break;
+            lo = hi;
+        }
+        if (lo == hi) return lo; // Never missed within the doubling budget
+    }
+
+    // k-section: every round probes thread_count interior points concurrently
+    int points = (thread_count < MAX_PROBE_THREADS) ? thread_count : MAX_PROBE_THREADS;
+    while (hi - lo > SENSITIVITY_FACTOR_TOLERANCE) {
+        for (int k = 0; k < points; ++k) {
+            factors[k] = lo + (hi - lo) * (k + 1) / (points + 1);
+            for (int i = 0; i < task_count; ++i) probes[k].wcet_per_task[i] = scaled_wcet(tasks_arr[i].wcet, factors[k]);
+        }
+        run_probe_batch(probes, points, thread_count);
+        *probes_run += points;
+        double new_lo = lo, new_hi = hi;
+        for (int k = 0; k < points; ++k) {
+            if (!probes[k].schedulable) { new_hi = factors[k]; break; }
+            new_lo = factors[k];
+        }
+        lo = new_lo; hi = new_hi;
+    }
+    return lo;
+}
+
+// Largest WCET of one task (others at nominal WCET) without misses, or -1 if the nominal set already misses
+int find_max_task_wcet(const Task tasks_arr[], int task_count, int task_index, const Job template_jobs[], int job_count,
+                       int hyperperiod, const SimulationOptions* options, int thread_count, int* probes_run) {
+    const Task* task = &tasks_arr[task_index];
+    double other_utilization = 0.0, other_density = 0.0;
+    for (int i = 0; i < task_count; ++i) {
+        if (i == task_index) continue;
+        int window = (tasks_arr[i].deadline < tasks_arr[i].period) ? tasks_arr[i].deadline : tasks_arr[i].period;
+        other_utilization += (double)tasks_arr[i].wcet / tasks_arr[i].period;
+        other_density += (double)tasks_arr[i].wcet / window;
+    }
+    int window = (task->deadline < task->period) ? task->deadline : task->period;
+    int sufficient = (int)floor(window * (1.0 - other_density) + 1e-9);
+    int necessary = (int)floor(task->period * (1.0 - other_utilization) + 1e-9);
+    if (necessary > task->deadline) necessary = task->deadline;
+    if (sufficient < task->wcet) sufficient = task->wcet;
+    if (necessary < sufficient) necessary = sufficient;
+
+    SensitivityProbe probes[MAX_PROBE_THREADS];
+    int wcets[MAX_PROBE_THREADS];
+    for (int k = 0; k < MAX_PROBE_THREADS; ++k) {
+        probes[k].template_jobs = template_jobs; probes[k].job_count = job_count; probes[k].hyperperiod = hyperperiod;
+        probes[k].options = options;
+        for (int i = 0; i < task_count; ++i) probes[k].wcet_per_task[i] = tasks_arr[i].wcet;
+    }
+
+    // Round 0: nominal WCET, analytic lower and upper candidates
+    wcets[0] = task->wcet; wcets[1] = sufficient; wcets[2] = necessary + 1;
+    for (int k = 0; k < 3; ++k) probes[k].wcet_per_task[task_index] = wcets[k];
+    run_probe_batch(probes, 3, thread_count);
+    *probes_run += 3;
+    if (!probes[0].schedulable) return -1;
+
+    int lo = task->wcet, hi = necessary + 1; // lo schedulable, hi not
+    if (probes[1].schedulable) lo = sufficient; else hi = sufficient;
+    if (hi == necessary + 1 && probes[2].schedulable) {
+        // Beyond the utilization bound but still no miss within the horizon: grow until a miss
+        lo = hi;
+        for (int d = 0; d < MAX_FACTOR_DOUBLINGS; ++d) {
+            if (lo >= task->deadline) return task->deadline; // A WCET beyond the deadline can never be met
+            hi = (lo * 2 < task->deadline) ? lo * 2 : task->deadline;
+            probes[0].wcet_per_task[task_index] = hi;
+            run_probe_batch(probes, 1, 1);
+            (*probes_run)++;
+            if (!probes[0].schedulable) break;
+            lo = hi;
+        }
+        if (lo == hi) return lo;
+    }
+
+    while (hi - lo > 1) {
+        int points = 0;
+        for (int k = 0; k < thread_count && k < MAX_PROBE_THREADS; ++k) {
+            int candidate = lo + (int)((long long)(hi - lo) * (k + 1) / (thread_count + 1));
+            if (candidate <= lo || (points > 0 && candidate == wcets[points - 1])) continue; // Integer grid collapses
+            wcets[points] = candidate;
+            probes[points].wcet_per_task[task_index] = candidate;
+            points++;
+        }
+        if (points == 0) { wcets[0] = lo + 1; probes[0].wcet_per_task[task_index] = lo + 1; points = 1; }
+        run_probe_batch(probes, points, thread_count);
+        *probes_run += points;
+        int new_lo = lo, new_hi = hi;
+        for (int k = 0; k < points; ++k) {
+            if (!probes[k].schedulable) { new_hi = wcets[k]; break; }
+            new_lo = wcets[k];
+        }
+        lo = new_lo; hi = new_hi;
+    }
+    return lo;
+}
+
+int run_sensitivity_analysis(const CliOptions* cli) {
+    int thread_count = resolve_thread_count(cli->thread_count);
+    FILE *outfile = fopen(cli->output_filename, "w");
+    if (!outfile) { perror("Error opening output file"); return 1; }
+    Job* jobs_list = malloc(MAX_JOBS * sizeof(Job));
+    if (!jobs_list) { fprintf(stderr, "Error: Failed malloc for sensitivity analysis.\n"); fclose(outfile); return 1; }
+    printf("Sensitivity analysis of %d task set(s) using %d thread(s).\n", cli->sensitivity_set_count, thread_count);
+
+    int failures = 0;
+    for (int set = 0; set < cli->sensitivity_set_count; ++set) {
+        const char* set_filename = cli->sensitivity_set_filenames[set];
+        Task tasks_list[MAX_TASKS];
+        int task_count = 0, job_count = 0;
+        if (!read_tasks(set_filename, tasks_list, &task_count)) { failures++; continue; }
+        long long hyperperiod_ll = calculate_hyperperiod(tasks_list, task_count);
+        if (hyperperiod_ll <= 0 || hyperperiod_ll > INT_MAX) { fprintf(stderr, "Error: Invalid hyperperiod for %s.\n", set_filename); failures++; continue; }
+        int hyperperiod = (int)hyperperiod_ll;
+        if (!generate_jobs(hyperperiod, tasks_list, task_count, jobs_list, &job_count) || job_count == 0) { failures++; continue; }
+
+        double utilization = 0.0;
+        for (int i = 0; i < task_count; ++i) utilization += (double)tasks_list[i].wcet / tasks_list[i].period;
+
+        int probes_run = 0;
+        double sufficient_bound = 0.0, necessary_bound = 0.0;
+        double factor = find_breakdown_factor(tasks_list, task_count, jobs_list, job_count, hyperperiod, &cli->sim, thread_count,
+                                              &sufficient_bound, &necessary_bound, &probes_run);
+
+        fprintf(outfile, "\n--- Sensitivity Analysis: %s ---\n", set_filename); printf("\n--- Sensitivity Analysis: %s ---\n", set_filename);
+        fprintf(outfile, "Algorithm: %s\n", policy_name(cli->sim.policy)); printf("Algorithm: %s\n", policy_name(cli->sim.policy));
+        fprintf(outfile, "Utilization: %.3f\n", utilization); printf("Utilization: %.3f\n", utilization);
+        fprintf(outfile, "Analytic factor bounds: %.3f (sufficient) .. %.3f (necessary)\n", sufficient_bound, necessary_bound);
+        printf("Analytic factor bounds: %.3f (sufficient) .. %.3f (necessary)\n", sufficient_bound, necessary_bound);
+        // Report the utilization of the rounded WCETs that were actually simulated, not U * factor
+        double breakdown_utilization = 0.0;
+        for (int i = 0; i < task_count; ++i) breakdown_utilization += (double)scaled_wcet(tasks_list[i].wcet, factor) / tasks_list[i].period;
+        fprintf(outfile, "Breakdown WCET scaling factor: %.3f (breakdown utilization %.3f)\n", factor, breakdown_utilization);
+        printf("Breakdown WCET scaling factor: %.3f (breakdown utilization %.3f)\n", factor, breakdown_utilization);
+
+        fprintf(outfile, "Task | WCET | Max WCET | Headroom\n");
+        fprintf(outfile, "-----|------|----------|------------------\n");
+        for (int i = 0; i < task_count; ++i) {
+            int max_wcet = find_max_task_wcet(tasks_list, task_count, i, jobs_list, job_count, hyperperiod, &cli->sim, thread_count, &probes_run);
+            if (max_wcet < 0) {
+                fprintf(outfile, "T%-3d | %4d | MISSES AT NOMINAL WCET\n", i, tasks_list[i].wcet);
+                printf("Task %d: misses deadlines at nominal WCET %d\n", i, tasks_list[i].wcet);
+                continue;
+            }
+            int increase = max_wcet - tasks_list[i].wcet;
+            double increase_pct = (double)increase * 100.0 / tasks_list[i].wcet;
+            fprintf(outfile, "T%-3d | %4d | %8d | +%d (+%.1f%%)\n", i, tasks_list[i].wcet, max_wcet, increase, increase_pct);
+            printf("Task %d: WCET %d -> max %d (+%d, +%.1f%%)\n", i, tasks_list[i].wcet, max_wcet, increase, increase_pct);
+        }
+        fprintf(outfile, "Simulation probes: %d\n", probes_run); printf("Simulation probes: %d\n", probes_run);
+    }
+
+    free(jobs_list);
+    fclose(outfile);
+    printf("Sensitivity analysis finished. Results saved to %s\n", cli->output_filename);
+    return failures > 0 ? 1 : 0;
+}
+
+
+// --- Partitioned Multicore Mode ---
+// Tasks are bin-packed onto cores by decreasing utilization. A core admits a task if its total density
+// stays <= 1, which is sufficient for LLF-class schedulers on one core. Each core is then an independent
+// uniprocessor MLLF simulation over the full hyperperiod, run on its own thread.
+
+double task_density(const Task* task) {
+    int window = (task->deadline < task->period) ? task->deadline : task->period;
+    return (double)task->wcet / window;
+}
+
+// Returns 1 if every task was placed, 0 otherwise (the offending task is reported)
+int partition_tasks(const Task tasks_arr[], int task_count, int core_count, FitHeuristic fit, TaskPartition* partition) {
+    memset(partition, 0, sizeof(*partition));
+    partition->core_count = core_count;
+
+    int order[MAX_TASKS];
+    for (int i = 0; i < task_count; ++i) order[i] = i;
+    for (int i = 1; i < task_count; ++i) { // Insertion sort: decreasing utilization, stable on task id
+        int current = order[i]; double u = (double)tasks_arr[current].wcet / tasks_arr[current].period;
+        int j = i - 1;
+        while (j >= 0 && (double)tasks_arr[order[j]].wcet / tasks_arr[order[j]].period < u) { order[j + 1] = order[j]; j--; }
+        order[j + 1] = current;
+    }
+
+    for (int k = 0; k < task_count; ++k) {
+        int tid = order[k];
+        double density = task_density(&tasks_arr[tid]);
+        int chosen = -1;
+        for (int core = 0; core < core_count; ++core) {
+            if (partition->core_density[core] + density > 1.0 + 1e-9) continue; // Admission test
+            if (chosen == -1) { chosen = core; if (fit == FIT_FIRST) break; continue; }
+            if (fit == FIT_BEST && partition->core_density[core] > partition->core_density[chosen]) chosen = core;
+            if (fit == FIT_WORST && partition->core_density[core] < partition->core_density[chosen]) chosen = core;
+        }
+        if (chosen == -1) {
+            fprintf(stderr, "Error: Task %d (density %.3f) does not fit on any of %d cores.\n", tid, density, core_count);
+            return 0;
+        }
+        partition->core_of_task[tid] = chosen;
+        partition->core_density[chosen] += density;
+        partition->core_task_count[chosen]++;
+    }
+    return 1;
+}
+
+void* core_simulation_main(void* arg) {
+    CoreSimulation* core = (CoreSimulation*)arg;
+    run_mllf_simulation(core->hyperperiod, core->jobs, core->job_count, core->trace, core->options, &core->counters, NULL);
+    return NULL;
+}
+
+int run_partitioned_simulation(const CliOptions* cli, const Task tasks_arr[], int task_count, Job jobs_arr[], int job_count,
+                               int hyperperiod, FILE* outfile) {
+    static const char* fit_names[] = { "first-fit decreasing", "best-fit decreasing", "worst-fit decreasing" };
+    TaskPartition partition;
+    if (!partition_tasks(tasks_arr, task_count, cli->partition_cores, cli->fit, &partition)) return 1;
+    printf("Partitioned %d tasks onto %d cores (%s).\n", task_count, partition.core_count, fit_names[cli->fit]);
+
+    CoreSimulation cores[MAX_CORES];
+    pthread_t threads[MAX_CORES];
+    bool started[MAX_CORES] = {false};
+    int status = 0;
+    memset(cores, 0, sizeof(cores));
+    for (int c = 0; c < partition.core_count; ++c) {
+        CoreSimulation* core = &cores[c];
+        core->core = c; core->hyperperiod = hyperperiod; core->options = &cli->sim;
+        core->jobs = malloc(job_count * sizeof(Job));
+        core->global_index = malloc(job_count * sizeof(int));
+        core->trace = tmpfile();
+        if (!core->jobs || !core->global_index || !core->trace) { fprintf(stderr, "Error: Failed to set up core %d.\n", c); status = 1; break; }
+        for (int i = 0; i < job_count; ++i) { // Keeps global job order, so job ID tie-breaks are unchanged
+            if (partition.core_of_task[jobs_arr[i].task_id] != c) continue;
+            core->global_index[core->job_count] = i;
+            core->jobs[core->job_count++] = jobs_arr[i];
+        }
+    }
+
+    for (int c = 0; status == 0 && c < partition.core_count; ++c) {
+        if (pthread_create(&threads[c], NULL, core_simulation_main, &cores[c]) == 0) started[c] = true;
+        else core_simulation_main(&cores[c]); // Fall back to running the core inline
+    }
+    for (int c = 0; c < partition.core_count; ++c) if (started[c]) pthread_join(threads[c], NULL);
+
+    SimulationCounters merged;
+    memset(&merged, 0, sizeof(merged));
+    if (status == 0) {
+        fprintf(outfile, "\n--- Partitioned Mode: %d cores, %s ---\n", partition.core_count, fit_names[cli->fit]);
+        fprintf(outfile, "Core | Tasks | Density | Jobs | Idle | Misses | Ctx Sw\n");
+        fprintf(outfile, "-----|-------|---------|------|------|--------|-------\n");
+        printf("\n--- Partitioned Mode: %d cores, %s ---\n", partition.core_count, fit_names[cli->fit]);
+        for (int c = 0; c < partition.core_count; ++c) {
+            const SimulationCounters* k = &cores[c].counters;
+            fprintf(outfile, "%4d | %5d | %7.3f | %4d | %4d | %6d | %6d\n", c, partition.core_task_count[c], partition.core_density[c],
+                    cores[c].job_count, k->idle_time, k->deadline_misses, k->context_switches);
+            printf("Core %d: %d tasks, density %.3f, %d jobs, idle %d, misses %d, context switches %d\n", c, partition.core_task_count[c],
+                   partition.core_density[c], cores[c].job_count, k->idle_time, k->deadline_misses, k->context_switches);
+            fprintf(outfile, "  Tasks:");
+            for (int t = 0; t < task_count; ++t) if (partition.core_of_task[t] == c) fprintf(outfile, " T%d", t);
+            fprintf(outfile, "\n");
+
+            merged.context_switches += k->context_switches; merged.deadline_misses += k->deadline_misses;
+            merged.completed_jobs += k->completed_jobs; merged.idle_time += k->idle_time;
+            merged.preemptions += k->preemptions; merged.reload_events += k->reload_events;
+            merged.overhead_time += k->overhead_time; merged.quantum_expirations += k->quantum_expirations;
+            merged.resetq_events += k->resetq_events;
+            for (int i = 0; i < cores[c].job_count; ++i) jobs_arr[cores[c].global_index[i]] = cores[c].jobs[i];
+        }
+
+        // Per-core traces in core order
+        char buffer[8192]; size_t n;
+        for (int c = 0; c < partition.core_count; ++c) {
+            fprintf(outfile, "\n=== Core %d Trace ===", c);
+            rewind(cores[c].trace);
+            while ((n = fread(buffer, 1, sizeof(buffer), cores[c].trace)) > 0) fwrite(buffer, 1, n, outfile);
+        }
+
+        // Time figures in the merged analysis are core-ticks (hyperperiod x cores)
+        fprintf(outfile, "\nMerged analysis over %d cores (time in core-ticks):", partition.core_count);
+        ScheduleSummary summary;
+        analyze_schedule_results(jobs_arr, job_count, tasks_arr, task_count, &cli->sim, &merged,
+                                 hyperperiod * partition.core_count, outfile, &summary);
+    }
+
+    for (int c = 0; c < partition.core_count; ++c) {
+        free(cores[c].jobs); free(cores[c].global_index);
+        if (cores[c].trace) fclose(cores[c].trace);
+    }
+    return status;
+}
+
+
+// --- Asynchronous Trace Writer ---
+// The simulation thread only fills TraceRecords; formatting, console mirroring and file I/O happen on
+// the writer thread. head/tail are free-running counters, slot = counter % TRACE_RING_CAPACITY.
+
+bool trace_writer_start(TraceWriter* writer, FILE* outfile, bool console_misses) {
+    memset(writer, 0, sizeof(*writer));
+    writer->records = malloc(TRACE_RING_CAPACITY * sizeof(TraceRecord));
+    writer->buffer = malloc(TRACE_WRITE_BUFFER_SIZE);
+    if (!writer->records || !writer->buffer) {
+        fprintf(stderr, "Error: Failed malloc for trace writer, trace disabled.\n");
+        free(writer->records); free(writer->buffer);
+        return false;
+    }
+    atomic_init(&writer->head, 0);
+    atomic_init(&writer->tail, 0);
+    atomic_init(&writer->closed, false);
+    writer->outfile = outfile;
+    writer->console_misses = console_misses;
+    fflush(outfile); // Everything written before the trace must precede it
+    writer->threaded = (pthread_create(&writer->thread, NULL, trace_writer_main, writer) == 0);
+    return true;
+}
+
+// Returns the next free slot, waiting while the ring is full
+TraceRecord* trace_writer_claim(TraceWriter* writer) {
+    size_t head = atomic_load_explicit(&writer->head, memory_order_relaxed);
+    int spins = 0;
+    while (head - atomic_load_explicit(&writer->tail, memory_order_acquire) >= TRACE_RING_CAPACITY) {
+        if (++spins < 64) continue;
+        struct timespec pause = {0, 20000}; // Writer is behind: back off 20us
+        nanosleep(&pause, NULL);
+    }
+    return &writer->records[head % TRACE_RING_CAPACITY];
+}
+
+void trace_writer_publish(TraceWriter* writer) {
+    size_t head = atomic_load_explicit(&writer->head, memory_order_relaxed);
+    if (!writer->threaded) { // No writer thread: consume in place
+        trace_writer_consume(writer, &writer->records[head % TRACE_RING_CAPACITY]);
+        atomic_store_explicit(&writer->tail, head + 1, memory_order_relaxed);
+    }
+    atomic_store_explicit(&writer->head, head + 1, memory_order_release);
+}
+
+// Drains all published records, flushes and releases the writer
+void trace_writer_stop(TraceWriter* writer) {
+    atomic_store_explicit(&writer->closed, true, memory_order_release);
+    if (writer->threaded) pthread_join(writer->thread, NULL);
+    trace_writer_flush(writer);
+    fflush(writer->outfile);
+    free(writer->records); free(writer->buffer);
+    writer->records = NULL; writer->buffer = NULL;
+}
+
+void* trace_writer_main(void* arg) {
+    TraceWriter* writer = (TraceWriter*)arg;
+    for (;;) {
+        size_t tail = atomic_load_explicit(&writer->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&writer->head, memory_order_acquire);
+        if (tail == head) {
+            if (atomic_load_explicit(&writer->closed, memory_order_acquire)) {
+                // closed is set after the last publish, so re-check head once before exiting
+                if (atomic_load_explicit(&writer->head, memory_order_acquire) == tail) break;
+                continue;
+            }
+            trace_writer_flush(writer); // Idle: hand what we have to the OS
+            struct timespec pause = {0, 50000};
+            nanosleep(&pause, NULL);
+            continue;
+        }
+        for (; tail != head; ++tail) trace_writer_consume(writer, &writer->records[tail % TRACE_RING_CAPACITY]);
+        atomic_store_explicit(&writer->tail, tail, memory_order_release);
+    }
+    return NULL;
+}
+
+void trace_writer_consume(TraceWriter* writer, const TraceRecord* record) {
+    if (writer->buffer_used + TRACE_MAX_RECORD_TEXT > TRACE_WRITE_BUFFER_SIZE) trace_writer_flush(writer);
+    int length = format_trace_record(record, writer->buffer + writer->buffer_used, TRACE_MAX_RECORD_TEXT);
+    if (record->type == TRACE_DEADLINE_MISS && writer->console_misses) {
+        fwrite(writer->buffer + writer->buffer_used, 1, length, stdout);
+    }
+    writer->buffer_used += length;
+}
+
+void trace_writer_flush(TraceWriter* writer) {
+    if (writer->buffer_used == 0) return;
+    if (fwrite(writer->buffer, 1, writer->buffer_used, writer->outfile) != writer->buffer_used) {
+        perror("Error writing trace");
+    }
+    writer->buffer_used = 0;
+}
+
+// Formats one record exactly as the synchronous trace did. Returns the number of bytes written.
+int format_trace_record(const TraceRecord* record, char* out, size_t size) {
+    int length;
+    if (record->type == TRACE_DEADLINE_MISS) {
+        length = snprintf(out, size, "!!! DEADLINE MISS: J%d deadline %d at time %d !!!\n", record->job_id, record->deadline, record->time);
+        return (length < (int)size) ? length : (int)size - 1;
+    }
+
+    length = snprintf(out, size, "%4d | %-42s | ", record->time, record->event_log);
+    if (record->running_job_id != -1) length += snprintf(out + length, size - length, " J%-3d(L%d,Q%d)|", record->running_job_id, record->running_laxity, record->running_quantum);
+    else length += snprintf(out + length, size - length, " %-12s |", "Idle");
+    length += snprintf(out + length, size - length, " ");
+    int chars_printed = 0;
+    for (int i = 0; i < record->ready_count && i < TRACE_READY_PREVIEW; ++i) {
+        int n = snprintf(out + length, size - length, "J%d:%d ", record->ready_job_ids[i], record->ready_laxities[i]);
+        length += n; chars_printed += n;
+        if (chars_printed > 18 && i < record->ready_count - 1) { length += snprintf(out + length, size - length, "..."); break; }
+    }
+    length += snprintf(out + length, size - length, "\n");
+    return length;
+}
+
+
+// --- Trace-Driven Replay ---
+// Jobs come from a recorded release trace instead of generate_jobs. The task file supplies WCET and
+// relative deadline per task id; arrival time and period are ignored. The trace is memory-mapped and
+// parsed on demand, and only jobs that are in flight or released within the lookahead window occupy
+// a pool slot. The window is the largest relative deadline: a job released later has a deadline after
+// every active job's, so it can never be Tmin and leaving it out keeps the quantums exact. Precise Tmin
+// and DVFS are rejected here: their comparison reports need the whole job set, and the DVFS slack
+// check looks further ahead than the window.
+
+int open_release_trace(const char* filename, ReleaseTrace* trace) {
+    memset(trace, 0, sizeof(*trace));
+    trace->last_release = INT_MIN;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) { perror("Error opening release trace"); return 0; }
+    struct stat st;
+    if (fstat(fd, &st) != 0) { perror("Error reading release trace"); close(fd); return 0; }
+    if (st.st_size == 0) { fprintf(stderr, "Error: Release trace %s is empty.\n", filename); close(fd); return 0; }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid
+    if (data == MAP_FAILED) { perror("Error mapping release trace"); return 0; }
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    trace->data = (const char*)data;
+    trace->size = (size_t)st.st_size;
+    trace->line = 1;
+    return 1;
+}
+
+// Parses the next record. Returns 1 on success, 0 at end of trace, -1 on a malformed or out-of-order record.
+int next_release_record(ReleaseTrace* trace, ReleaseRecord* record) {
+    int values[3];
+    for (int v = 0; v < 3; ++v) {
+        while (trace->offset < trace->size && (trace->data[trace->offset] == ' ' || trace->data[trace->offset] == '\t' ||
+                                               trace->data[trace->offset] == '\r' || trace->data[trace->offset] == '\n')) {
+            if (trace->data[trace->offset] == '\n') trace->line++;
+            trace->offset++;
+        }
+        if (trace->offset >= trace->size) {
+            if (v == 0) return 0;
+            fprintf(stderr, "Error: Incomplete release record at line %d of release trace.\n", trace->line); return -1;
+        }
+        bool negative = (trace->data[trace->offset] == '-');
+        if (negative) trace->offset++;
+        long long value = 0; size_t start = trace->offset;
+        while (trace->offset < trace->size && trace->data[trace->offset] >= '0' && trace->data[trace->offset] <= '9') {
+            value = value * 10 + (trace->data[trace->offset++] - '0');
+            if (value > INT_MAX) { fprintf(stderr, "Error: Value out of range at line %d of release trace.\n", trace->line); return -1; }
+        }
+        if (trace->offset == start) { fprintf(stderr, "Error: Invalid release record format line %d.\n", trace->line); return -1; }
+        values[v] = negative ? -(int)value : (int)value;
+    }
+    record->task_id = values[0]; record->release_time = values[1]; record->aet = values[2];
+    if (record->release_time < 0 || record->aet <= 0) {
+        fprintf(stderr, "Error: Negative release time or non-positive AET at line %d of release trace.\n", trace->line); return -1;
+    }
+    if (record->release_time < trace->last_release) {
+        fprintf(stderr, "Error: Release trace not sorted by release time at line %d (%d after %d).\n", trace->line, record->release_time, trace->last_release);
+        return -1;
+    }
+    trace->last_release = record->release_time;
+    return 1;
+}
+
+void close_release_trace(ReleaseTrace* trace) {
+    if (trace->data != NULL) munmap((void*)trace->data, trace->size);
+    trace->data = NULL;
+}
+
+// Returns the lowest free slot, or NULL if the pool is full
+Job* job_pool_admit(JobPool* pool) {
+    for (int i = 0; i < REPLAY_POOL_SIZE; ++i) {
+        if (pool->in_use[i]) continue;
+        pool->in_use[i] = true;
+        if (i >= pool->high_water) pool->high_water = i + 1;
+        if (++pool->live > pool->peak_live) pool->peak_live = pool->live;
+        return &pool->slots[i];
+    }
+    return NULL;
+}
+
+// Folds completed jobs into the summary and frees the slots of completed and missed jobs.
+// Jitter compares consecutive completions of a task (retirement order).
+void job_pool_retire_finished(JobPool* pool, ScheduleSummary* summary) {
+    for (int i = 0; i < pool->high_water; ++i) {
+        Job* job = &pool->slots[i];
+        if (!pool->in_use[i] || (job->status != COMPLETED && job->status != MISSED)) continue;
+        if (job->status == COMPLETED) {
+            int turnaround = job->finish_time - job->arrival_time;
+            int waiting = turnaround - job->aet;
+            if (waiting < 0) waiting = 0;
+            int response = (job->first_start_time >= job->arrival_time) ? (job->first_start_time - job->arrival_time) : 0;
+            accumulate_job_statistics(summary, job->task_id, turnaround, waiting, response);
+        }
+        job->status = COMPLETED; // Free slots look retired to the engine
+        pool->in_use[i] = false;
+        pool->live--;
+    }
+    while (pool->high_water > 0 && !pool->in_use[pool->high_water - 1]) pool->high_water--;
+}
+
+int run_replay_simulation(const CliOptions* cli) {
+    Task tasks_list[MAX_TASKS];
+    int task_count = 0;
+    if (!read_tasks(cli->task_filename, tasks_list, &task_count)) return 1;
+    int lookahead = 0;
+    for (int i = 0; i < task_count; ++i) if (tasks_list[i].deadline > lookahead) lookahead = tasks_list[i].deadline;
+
+    ReleaseTrace trace;
+    if (!open_release_trace(cli->aet_filename, &trace)) return 1;
+    printf("Replaying releases from %s (%zu bytes mapped, lookahead %d ticks)...\n", cli->aet_filename, trace.size, lookahead);
+
+    JobPool pool = {0};
+    pool.slots = malloc(REPLAY_POOL_SIZE * sizeof(Job));
+    pool.in_use = calloc(REPLAY_POOL_SIZE, sizeof(bool));
+    FILE *outfile = fopen(cli->output_filename, "w");
+    if (!pool.slots || !pool.in_use || !outfile) {
+        if (!outfile) perror("Error opening output file"); else fprintf(stderr, "Error: Failed malloc for replay job pool.\n");
+        free(pool.slots); free(pool.in_use); if (outfile) fclose(outfile); close_release_trace(&trace);
+        return 1;
+    }
+    printf("Output will be written to %s\n", cli->output_filename);
+
+    SimulationCounters counters;
+    SimulationState state;
+    init_simulation_state(&state, &cli->sim, &counters);
+    ScheduleSummary summary;
+    init_schedule_summary(&summary, 0, task_count, &cli->sim, &counters, 0);
+
+    fprintf(outfile, "\n--- %s Simulation Trace (Replay: %s) ---\n", policy_name(cli->sim.policy), cli->aet_filename);
+    fprintf(outfile, "Time | Event%-40s | Run Job(L,Q)| Ready Queue (JobId:Laxity)\n", "");
+    fprintf(outfile, "-----|--------------------------------------------|--------------|--------------------------\n");
+    TraceWriter writer;
+    if (trace_writer_start(&writer, outfile, !cli->sim.quiet_misses)) state.trace = &writer;
+
+    int instance_of_task[MAX_TASKS] = {0};
+    int released = 0, over_wcet = 0, status = 0;
+    ReleaseRecord pending;
+    int have_pending = next_release_record(&trace, &pending);
+    while (have_pending >= 0) {
+        // Admit every release inside the lookahead window
+        while (have_pending == 1 && pending.release_time <= state.current_time + lookahead) {
+            if (pending.task_id < 0 || pending.task_id >= task_count) {
+                fprintf(stderr, "Error: Unknown task id %d at line %d of release trace.\n", pending.task_id, trace.line);
+                have_pending = -1; break;
+            }
+            Job* job = job_pool_admit(&pool);
+            if (job == NULL) { fprintf(stderr, "Error: More than %d jobs in flight during replay.\n", REPLAY_POOL_SIZE); have_pending = -1; break; }
+            const Task* task = &tasks_list[pending.task_id];
+            memset(job, 0, sizeof(*job));
+            job->job_id = released++;
+            job->task_id = task->id;
+            job->instance_number = instance_of_task[task->id]++;
+            job->arrival_time = pending.release_time;
+            job->wcet = job->remaining_wcet = task->wcet;
+            job->aet = job->remaining_aet = pending.aet;
+            if (pending.aet > task->wcet) over_wcet++;
+            if ((long long)pending.release_time + task->deadline > INT_MAX) { fprintf(stderr, "Error: Absolute deadline > INT_MAX at line %d.\n", trace.line); have_pending = -1; break; }
+            job->absolute_deadline = pending.release_time + task->deadline;
+            job->calculated_laxity = INT_MAX;
+            job->status = NOT_ARRIVED;
+            job->first_start_time = job->last_start_time = job->finish_time = -1;
+            job->response_time = job->turnaround_time = job->waiting_time = -1;
+            have_pending = next_release_record(&trace, &pending);
+        }
+        if (have_pending < 0) { status = 1; break; }
+        if (have_pending == 0 && pool.live == 0) break; // Trace exhausted and every job retired
+
+        simulate_mllf_tick(&state, pool.slots, pool.high_water);
+        job_pool_retire_finished(&pool, &summary);
+    }
+
+    if (state.trace != NULL) trace_writer_stop(&writer);
+    fprintf(outfile, "-----|--------------------------------------------|--------------|--------------------------\n");
+    close_release_trace(&trace);
+    if (over_wcet > 0) fprintf(stderr, "Warning: %d released job(s) had AET > WCET.\n", over_wcet);
+
+    if (status == 0) {
+        summary.hyperperiod = state.current_time; // Total time simulated
+        summary.job_count = released;
+        summary.counters = counters;
+        print_summary_counters(&summary, outfile);
+        fprintf(outfile, "Peak jobs in flight (incl. lookahead): %d of %d slots\n", pool.peak_live, REPLAY_POOL_SIZE);
+        printf("Peak jobs in flight (incl. lookahead): %d of %d slots\n", pool.peak_live, REPLAY_POOL_SIZE);
+        print_summary_statistics(&summary, outfile);
+    }
+
+    free(pool.slots); free(pool.in_use);
+    fclose(outfile);
+    if (status == 0) printf("Simulation finished. Results saved to %s\n", cli->output_filename);
+    return status;
+}
@@ -1,379 +1,440 @@
-class MLLFScheduler {
+const LOG_LIMIT = 500; // Log entries kept in the DOM
+
+// Per-tick schedule received from the simulation worker, kept in growable typed arrays
+class TimelineStore {
     constructor() {
-        this.tasks = [];
-        this.jobs = [];
-        this.currentTime = 0;
-        this.simulationTime = 30;
-        this.isRunning = false;
-        this.isPaused = false;
-        this.readyQueue = [];
-        this.runningJob = null;
-        this.currentQuantum = 0;
-        
-        // Statistics
-        this.contextSwitches = 0;
-        this.deadlineMisses = 0;
-        this.completedJobs = 0;
-        this.idleTime = 0;
-        this.lastRunningJobId = -1;
-        
-        // Timeline data
-        this.timeline = [];
-        this.speed = 1000;
-        
-        this.initializeEventListeners();
+        this.reset();
     }
 
-    initializeEventListeners() {
-        document.getElementById('speedControl').addEventListener('change', (e) => {
-            this.speed = parseInt(e.target.value);
-        });
+    reset() {
+        this.origin = 0; // Time of the first stored tick
+        this.length = 0;
+        this.jobIds = new Int32Array(1024);
+        this.taskIds = new Int32Array(1024);
+        this.misses = [];
+        this.taskCount = 0;
     }
 
-    addTask(arrival, period, wcet, deadline, aet) {
-        const task = {
-            id: this.tasks.length,
-            arrival,
-            period,
-            wcet,
-            deadline,
-            aet
-        };
-        this.tasks.push(task);
-        this.updateTasksDisplay();
-        return task;
+    append(start, jobIds, taskIds) {
+        if (this.length === 0) this.origin = start;
+        const needed = this.length + jobIds.length;
+        if (needed > this.jobIds.length) {
+            let capacity = this.jobIds.length;
+            while (capacity < needed) capacity *= 2;
+            const grownJobs = new Int32Array(capacity);
+            grownJobs.set(this.jobIds.subarray(0, this.length));
+            const grownTasks = new Int32Array(capacity);
+            grownTasks.set(this.taskIds.subarray(0, this.length));
+            this.jobIds = grownJobs;
+            this.taskIds = grownTasks;
+        }
+        this.jobIds.set(jobIds, this.length);
+        this.taskIds.set(taskIds, this.length);
+        this.length = needed;
     }
 
-    removeTask(taskId) {
-        this.tasks = this.tasks.filter(task => task.id !== taskId);
-        this.tasks.forEach((task, index) => {
-            task.id = index;
-        });
-        this.updateTasksDisplay();
+    endTime() {
+        return this.origin + this.length;
+    }
+}
+
+// Canvas Gantt chart: a CPU row plus one row per task. Only the visible time range is drawn, ticks are
+// merged per pixel column when zoomed out, and new ticks are painted without redrawing the rest.
+class TimelineView {
+    constructor(canvas, store) {
+        this.canvas = canvas;
+        this.ctx = canvas.getContext('2d');
+        this.store = store;
+        this.viewStart = 0; // Time at the left edge
+        this.pxPerTick = 20;
+        this.follow = true; // Keep the newest tick in view
+        this.paintedUntil = 0; // Ticks before this time are painted for the current viewport
+        this.needsFullPaint = true;
+        this.frameRequested = false;
+
+        this.labelWidth = 50;
+        this.axisHeight = 22;
+        this.rowHeight = 22;
+        this.rowGap = 6;
+
+        this.initializeInteraction();
+        new ResizeObserver(() => this.invalidate()).observe(canvas);
     }
 
-    generateJobs() {
-        this.jobs = [];
-        let jobId = 0;
-
-        for (let task of this.tasks) {
-            let k = 0;
-            let arrivalTime = task.arrival + k * task.period;
-            
-            while (arrivalTime < this.simulationTime) {
-                const job = {
-                    jobId: jobId++,
-                    taskId: task.id,
-                    instanceNumber: k,
-                    arrivalTime: arrivalTime,
-                    wcet: task.wcet,
-                    aet: task.aet,
-                    remainingAet: task.aet,
-                    remainingWcet: task.wcet,
-                    absoluteDeadline: arrivalTime + task.deadline,
-                    calculatedLaxity: 0,
-                    status: 'NOT_ARRIVED',
-                    firstStartTime: -1,
-                    lastStartTime: -1,
-                    finishTime: -1
-                };
-                this.jobs.push(job);
-                
-                k++;
-                arrivalTime = task.arrival + k * task.period;
+    initializeInteraction() {
+        this.canvas.addEventListener('wheel', (e) => {
+            e.preventDefault();
+            const factor = e.deltaY < 0 ? 1.25 : 0.8;
+            this.zoom(factor, this.timeAt(e.offsetX));
+        }, { passive: false });
+
+        let dragX = null;
+        this.canvas.addEventListener('mousedown', (e) => { dragX = e.offsetX; });
+        window.addEventListener('mouseup', () => { dragX = null; });
+        this.canvas.addEventListener('mousemove', (e) => {
+            if (dragX !== null) {
+                this.pan((dragX - e.offsetX) / this.pxPerTick);
+                dragX = e.offsetX;
             }
-        }
+            this.canvas.title = this.describe(Math.floor(this.timeAt(e.offsetX)));
+        });
     }
 
-    calculateLaxity(job) {
-        if (job.status === 'COMPLETED' || job.status === 'MISSED') {
-            return Infinity;
-        }
-        return job.absoluteDeadline - this.currentTime - job.remainingWcet;
+    chartWidth() {
+        return Math.max(1, this.canvas.clientWidth - this.labelWidth);
     }
 
-    updateAllLaxities() {
-        for (let job of this.readyQueue) {
-            job.calculatedLaxity = this.calculateLaxity(job);
-        }
-        if (this.runningJob) {
-            this.runningJob.calculatedLaxity = this.calculateLaxity(this.runningJob);
-        }
+    visibleTicks() {
+        return this.chartWidth() / this.pxPerTick;
     }
 
-    selectMLLFTask() {
-        if (this.readyQueue.length === 0 && !this.runningJob) {
-            return null;
-        }
+    timeAt(x) {
+        return this.viewStart + (x - this.labelWidth) / this.pxPerTick;
+    }
 
-        this.updateAllLaxities();
-        
-        let candidates = [...this.readyQueue];
-        if (this.runningJob && this.runningJob.status === 'RUNNING') {
-            candidates.push(this.runningJob);
-        }
+    xOf(time) {
+        return this.labelWidth + (time - this.viewStart) * this.pxPerTick;
+    }
 
-        if (candidates.length === 0) return null;
+    rowCount() {
+        return 1 + this.store.taskCount;
+    }
 
-        // Find minimum laxity
-        let minLaxity = Math.min(...candidates.map(job => job.calculatedLaxity));
-        let minLaxityJobs = candidates.filter(job => job.calculatedLaxity === minLaxity);
+    rowTop(row) {
+        return this.axisHeight + row * (this.rowHeight + this.rowGap);
+    }
 
-        // Among jobs with minimum laxity, select the one with minimum remaining WCET
-        let minRemainingWcet = Math.min(...minLaxityJobs.map(job => job.remainingWcet));
-        let finalCandidates = minLaxityJobs.filter(job => job.remainingWcet === minRemainingWcet);
+    taskColor(taskId) {
+        return taskId < 0 ? '#718096' : `hsl(${(taskId * 67) % 360}, 60%, 50%)`;
+    }
 
-        // Tie-break with job ID
-        return finalCandidates.reduce((min, job) => 
-            job.jobId < min.jobId ? job : min
-        );
+    describe(time) {
+        const index = time - this.store.origin;
+        if (index < 0 || index >= this.store.length) return '';
+        const jobId = this.store.jobIds[index];
+        if (jobId < 0) return `Time ${time}: Idle`;
+        const taskId = this.store.taskIds[index];
+        return `Time ${time}: J${jobId}` + (taskId >= 0 ? ` (T${taskId})` : '');
     }
 
-    calculateQuantum(taskTa) {
-        if (!taskTa || taskTa.remainingAet <= 0) {
-            return 0;
-        }
+    zoom(factor, anchorTime) {
+        const minPx = this.chartWidth() / Math.max(1, this.store.length);
+        const previous = this.pxPerTick;
+        this.pxPerTick = Math.min(80, Math.max(Math.min(minPx, 1), this.pxPerTick * factor));
+        this.viewStart = anchorTime - (anchorTime - this.viewStart) * (previous / this.pxPerTick);
+        this.follow = false;
+        this.clampView();
+        this.invalidate();
+    }
 
-        // Find earliest deadline among jobs with higher laxity
-        let earliestDeadline = Infinity;
-        let taLaxity = taskTa.calculatedLaxity;
+    pan(ticks) {
+        this.viewStart += ticks;
+        this.follow = false;
+        this.clampView();
+        this.invalidate();
+    }
 
-        for (let job of this.jobs) {
-            if (job === taskTa || job.status === 'COMPLETED' || job.status === 'MISSED') {
-                continue;
-            }
+    fit() {
+        this.pxPerTick = this.chartWidth() / Math.max(1, this.store.length);
+        this.viewStart = this.store.origin;
+        this.follow = true;
+        this.invalidate();
+    }
 
-            let jobLaxity = this.calculateLaxity(job);
-            if (jobLaxity > taLaxity && job.absoluteDeadline < earliestDeadline) {
-                earliestDeadline = job.absoluteDeadline;
-            }
-        }
+    clampView() {
+        const maxStart = Math.max(this.store.origin, this.store.endTime() - this.visibleTicks());
+        this.viewStart = Math.min(Math.max(this.viewStart, this.store.origin), maxStart);
+    }
 
-        if (earliestDeadline === Infinity || taskTa.absoluteDeadline <= earliestDeadline) {
-            // Run until completion
-            return taskTa.remainingAet;
-        } else {
-            // Quantum = Dmin - La
-            let quantum = earliestDeadline - taLaxity;
-            return Math.max(1, Math.min(quantum, taskTa.remainingAet));
-        }
+    invalidate() {
+        this.needsFullPaint = true;
+        this.requestPaint();
     }
 
-    handleArrivals() {
-        let arrivals = [];
-        for (let job of this.jobs) {
-            if (job.status === 'NOT_ARRIVED' && job.arrivalTime === this.currentTime) {
-                job.status = 'READY';
-                this.readyQueue.push(job);
-                arrivals.push(job);
-            }
+    // New ticks arrived. In follow mode the view jumps ahead by most of a screen once the data reaches
+    // the right edge, so a full repaint happens once per screen rather than once per tick.
+    dataAppended() {
+        if (this.follow && this.store.endTime() > this.viewStart + this.visibleTicks()) {
+            this.viewStart = Math.max(this.store.origin, this.store.endTime() - this.visibleTicks() * 0.1);
+            this.needsFullPaint = true;
         }
-        return arrivals;
-    }
-
-    handleCompletion() {
-        if (this.runningJob && this.runningJob.remainingAet <= 0 && 
-            this.runningJob.status !== 'COMPLETED' && this.runningJob.status !== 'MISSED') {
-            
-            this.runningJob.status = 'COMPLETED';
-            this.runningJob.finishTime = this.currentTime;
-            this.completedJobs++;
-            
-            let completedJob = this.runningJob;
-            this.runningJob = null;
-            this.currentQuantum = 0;
-            
-            return completedJob;
+        this.requestPaint();
+    }
+
+    requestPaint() {
+        if (this.frameRequested) return;
+        this.frameRequested = true;
+        requestAnimationFrame(() => {
+            this.frameRequested = false;
+            this.paint();
+        });
+    }
+
+    paint() {
+        const dpr = window.devicePixelRatio || 1;
+        const width = this.canvas.clientWidth;
+        const height = this.rowTop(this.rowCount()) + 4;
+        if (this.canvas.height !== Math.round(height * dpr) || this.canvas.width !== Math.round(width * dpr)) {
+            this.canvas.style.height = `${height}px`;
+            this.canvas.width = Math.round(width * dpr);
+            this.canvas.height = Math.round(height * dpr);
+            this.needsFullPaint = true;
         }
-        return null;
-    }
-
-    makeSchedulingDecision(candidateTa) {
-        let events = [];
-        let contextSwitch = false;
-
-        if (!this.runningJob) {
-            // CPU Idle
-            if (candidateTa) {
-                this.runningJob = candidateTa;
-                this.runningJob.status = 'RUNNING';
-                this.readyQueue = this.readyQueue.filter(job => job !== candidateTa);
-                this.currentQuantum = this.calculateQuantum(this.runningJob);
-                
-                if (this.runningJob.firstStartTime === -1) {
-                    this.runningJob.firstStartTime = this.currentTime;
-                }
-                this.runningJob.lastStartTime = this.currentTime;
-                
-                events.push(`Start J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
-            } else {
-                events.push('CPU Idle');
-                this.idleTime++;
-            }
-        } else {
-            // CPU Busy
-            if (!candidateTa) {
-                events.push(`Continue J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
-            } else if (candidateTa !== this.runningJob) {
-                // Preemption
-                events.push(`Preempt J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity}) for J${candidateTa.jobId}(L${candidateTa.calculatedLaxity})`);
-                
-                this.runningJob.status = 'READY';
-                this.readyQueue.push(this.runningJob);
-                
-                this.runningJob = candidateTa;
-                this.runningJob.status = 'RUNNING';
-                this.readyQueue = this.readyQueue.filter(job => job !== candidateTa);
-                this.currentQuantum = this.calculateQuantum(this.runningJob);
-                
-                if (this.runningJob.firstStartTime === -1) {
-                    this.runningJob.firstStartTime = this.currentTime;
-                }
-                this.runningJob.lastStartTime = this.currentTime;
-                
-                contextSwitch = true;
-            } else {
-                // Continue or reset quantum
-                if (this.currentQuantum <= 0 && this.runningJob.remainingAet > 0) {
-                    this.currentQuantum = this.calculateQuantum(this.runningJob);
-                    events.push(`ResetQ J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
-                } else {
-                    events.push(`Continue J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
-                }
-            }
+        this.ctx.setTransform(dpr, 0, 0, dpr, 0, 0);
+
+        const viewEnd = this.viewStart + this.visibleTicks();
+        if (this.needsFullPaint) {
+            this.ctx.clearRect(0, 0, width, height);
+            this.drawAxis(viewEnd);
+            this.drawLabels();
+            this.paintedUntil = Math.max(this.store.origin, Math.floor(this.viewStart));
+            this.needsFullPaint = false;
         }
 
-        // Check for context switch
-        let currentRunningJobId = this.runningJob ? this.runningJob.jobId : -1;
-        if (currentRunningJobId !== this.lastRunningJobId && 
-            currentRunningJobId !== -1 && this.lastRunningJobId !== -1) {
-            this.contextSwitches++;
-            contextSwitch = true;
+        const end = Math.min(this.store.endTime(), Math.ceil(viewEnd));
+        if (end > this.paintedUntil) {
+            // Repaint the last painted run too, so a job that keeps running stays one segment
+            let from = this.paintedUntil;
+            const first = Math.max(this.store.origin, Math.floor(this.viewStart));
+            const last = this.store.jobIds[from - 1 - this.store.origin];
+            while (from > first && this.store.jobIds[from - 1 - this.store.origin] === last) from--;
+            this.drawTicks(from, end);
+            this.paintedUntil = end;
         }
-        this.lastRunningJobId = currentRunningJobId;
+    }
 
-        if (contextSwitch) {
-            events.push('(CS)');
+    drawAxis(viewEnd) {
+        const ctx = this.ctx;
+        ctx.fillStyle = '#4a5568';
+        ctx.font = '11px Segoe UI, sans-serif';
+        ctx.textBaseline = 'middle';
+        // Label step: 1, 2, 5 x 10^n with at least 60px between labels
+        let step = 1;
+        for (let i = 0, scale = 1; step * this.pxPerTick < 60; i++) {
+            step = [1, 2, 5][i % 3] * scale;
+            if (i % 3 === 2) scale *= 10;
+        }
+        for (let t = Math.ceil(this.viewStart / step) * step; t <= viewEnd; t += step) {
+            const x = this.xOf(t);
+            ctx.fillRect(x, this.axisHeight - 6, 1, 6);
+            ctx.fillText(String(t), x + 3, this.axisHeight / 2);
         }
+    }
 
-        return events;
+    drawLabels() {
+        const ctx = this.ctx;
+        ctx.fillStyle = '#4a5568';
+        ctx.font = '600 12px Segoe UI, sans-serif';
+        ctx.textBaseline = 'middle';
+        ctx.fillText('CPU', 4, this.rowTop(0) + this.rowHeight / 2);
+        for (let task = 0; task < this.store.taskCount; task++) {
+            ctx.fillText(`T${task}`, 4, this.rowTop(task + 1) + this.rowHeight / 2);
+        }
     }
 
-    executeRunningJob() {
-        if (this.runningJob && this.runningJob.status === 'RUNNING') {
-            if (this.runningJob.remainingAet > 0) {
-                this.runningJob.remainingAet--;
-            }
-            if (this.runningJob.remainingWcet > 0) {
-                this.runningJob.remainingWcet--;
-            }
-            if (this.currentQuantum > 0) {
-                this.currentQuantum--;
+    // Paints [from, to). Runs of the same job become one rectangle; when several ticks share a pixel
+    // column the column shows the first busy tick on the CPU row and every task that ran on task rows.
+    drawTicks(from, to) {
+        const ctx = this.ctx;
+        const store = this.store;
+        const ticksPerColumn = Math.max(1, Math.floor(1 / this.pxPerTick));
+        if (ticksPerColumn > 1) from -= (from - store.origin) % ticksPerColumn; // Repaint a partly painted column
+        const left = Math.max(this.labelWidth, this.xOf(from));
+        ctx.clearRect(left, this.axisHeight, this.xOf(to) - left + 1, this.rowTop(this.rowCount()) - this.axisHeight);
+        ctx.save();
+        ctx.beginPath();
+        ctx.rect(this.labelWidth, 0, this.chartWidth(), this.rowTop(this.rowCount()));
+        ctx.clip(); // Segments starting left of the view must not cover the row labels
+
+        const seen = new Int32Array(store.taskCount).fill(-1);
+        let t = from;
+        while (t < to) {
+            const index = t - store.origin;
+            const jobId = store.jobIds[index];
+            let runEnd = t + 1;
+            if (ticksPerColumn === 1) {
+                while (runEnd < to && store.jobIds[runEnd - store.origin] === jobId) runEnd++;
+                this.drawSegment(t, runEnd, jobId, store.taskIds[index]);
+            } else {
+                runEnd = Math.min(to, t + ticksPerColumn);
+                let firstBusy = -1;
+                for (let i = t; i < runEnd; i++) {
+                    const task = store.taskIds[i - store.origin];
+                    if (store.jobIds[i - store.origin] >= 0 && firstBusy < 0) firstBusy = i;
+                    if (task >= 0) seen[task] = t;
+                }
+                const shown = firstBusy >= 0 ? firstBusy : t;
+                this.drawCpuCell(t, runEnd, store.jobIds[shown - store.origin], store.taskIds[shown - store.origin]);
+                for (let task = 0; task < store.taskCount; task++) {
+                    if (seen[task] === t) this.drawTaskCell(t, runEnd, task);
+                }
             }
+            t = runEnd;
         }
+        this.drawMisses(from, to);
+        ctx.restore();
     }
 
-    checkDeadlineMisses() {
-        let misses = [];
-        let nextTime = this.currentTime + 1;
+    drawCpuCell(from, to, jobId, taskId) {
+        const x = this.xOf(from);
+        const w = Math.max(1, this.xOf(to) - x);
+        this.ctx.fillStyle = jobId >= 0 ? this.taskColor(taskId) : '#cbd5e0';
+        this.ctx.fillRect(x, this.rowTop(0), w, this.rowHeight);
+    }
 
-        // Check running job
-        if (this.runningJob && this.runningJob.status === 'RUNNING') {
-            if (nextTime > this.runningJob.absoluteDeadline && this.runningJob.remainingAet > 0) {
-                this.runningJob.status = 'MISSED';
-                this.deadlineMisses++;
-                misses.push(this.runningJob);
-                this.runningJob = null;
-                this.currentQuantum = 0;
-            }
-        }
+    drawTaskCell(from, to, taskId) {
+        const x = this.xOf(from);
+        this.ctx.fillStyle = this.taskColor(taskId);
+        this.ctx.fillRect(x, this.rowTop(taskId + 1), Math.max(1, this.xOf(to) - x), this.rowHeight);
+    }
 
-        // Check ready queue
-        for (let i = this.readyQueue.length - 1; i >= 0; i--) {
-            let job = this.readyQueue[i];
-            if (nextTime > job.absoluteDeadline) {
-                job.status = 'MISSED';
-                this.deadlineMisses++;
-                misses.push(job);
-                this.readyQueue.splice(i, 1);
-            }
+    drawSegment(from, to, jobId, taskId) {
+        const ctx = this.ctx;
+        this.drawCpuCell(from, to, jobId, taskId);
+        if (jobId >= 0 && taskId >= 0 && taskId < this.store.taskCount) this.drawTaskCell(from, to, taskId);
+        const x = this.xOf(from);
+        const w = this.xOf(to) - x;
+        if (this.pxPerTick >= 4) { // Run boundary
+            ctx.fillStyle = 'rgba(255, 255, 255, 0.6)';
+            ctx.fillRect(x + w - 1, this.rowTop(0), 1, this.rowHeight);
+        }
+        if (jobId >= 0 && w >= 28) {
+            ctx.fillStyle = 'white';
+            ctx.font = '600 11px Segoe UI, sans-serif';
+            ctx.textBaseline = 'middle';
+            ctx.fillText(`J${jobId}`, x + 4, this.rowTop(0) + this.rowHeight / 2);
         }
-
-        return misses;
     }
 
-    simulateStep() {
-        if (this.currentTime >= this.simulationTime) {
-            this.stopSimulation();
-            return;
+    drawMisses(from, to) {
+        const ctx = this.ctx;
+        ctx.fillStyle = '#e53e3e';
+        for (let miss of this.store.misses) {
+            if (miss.time < from || miss.time > to) continue;
+            const x = this.xOf(miss.time);
+            const row = miss.taskId >= 0 && miss.taskId < this.store.taskCount ? miss.taskId + 1 : 0;
+            ctx.fillRect(x - 1, this.rowTop(0), 2, this.rowTop(row) + this.rowHeight - this.rowTop(0));
+            ctx.beginPath();
+            ctx.moveTo(x - 5, this.rowTop(0) - 6);
+            ctx.lineTo(x + 5, this.rowTop(0) - 6);
+            ctx.lineTo(x, this.rowTop(0));
+            ctx.fill();
         }
+    }
+}
+
+// Page controller: task configuration, the simulation worker and the displays
+class MLLFScheduler {
+    constructor() {
+        this.tasks = [];
+        this.currentTime = 0;
+        this.simulationTime = 30;
+        this.isRunning = false;
+        this.stats = { contextSwitches: 0, deadlineMisses: 0, completedJobs: 0, idleTime: 0 };
+        this.state = { runningJob: null, readyQueue: [] };
+        this.speed = 1000;
 
-        let events = [];
-        let requiresReschedule = false;
+        this.store = new TimelineStore();
+        this.timelineView = new TimelineView(document.getElementById('timelineCanvas'), this.store);
+        this.displayUpdateRequested = false;
+        this.pendingLog = [];
+        this.generation = 0; // Bumped on every reset; worker replies from an older run are dropped
 
-        // Handle arrivals
-        let arrivals = this.handleArrivals();
-        if (arrivals.length > 0) {
-            arrivals.forEach(job => {
-                events.push(`Arrival J${job.jobId}(T${job.taskId})`);
-            });
-            requiresReschedule = true;
-        }
+        this.worker = this.createWorker();
+        this.initializeEventListeners();
+    }
 
-        // Handle completion
-        let completed = this.handleCompletion();
-        if (completed) {
-            events.push(`Complete J${completed.jobId}`);
-            requiresReschedule = true;
+    // The worker cannot be started from file:// in some browsers; the engine then runs on the page
+    createWorker() {
+        try {
+            const worker = new Worker('simulation-worker.js');
+            worker.onmessage = (e) => this.handleWorkerMessage(e.data);
+            worker.onerror = () => {
+                this.logMessage('Simulation worker unavailable, running on the page instead. Start again.', 'warning');
+                this.worker = this.createLocalWorker();
+                this.stopSimulation();
+            };
+            return worker;
+        } catch (error) {
+            return this.createLocalWorker();
         }
+    }
 
-        // Check quantum expiration
-        if (this.runningJob && this.currentQuantum <= 0 && this.runningJob.remainingAet > 0) {
-            events.push(`Quantum Exp J${this.runningJob.jobId}`);
-            requiresReschedule = true;
-        }
+    createLocalWorker() {
+        return {
+            postMessage: (msg) => setTimeout(() => handleWorkerMessage(msg, (reply) => this.handleWorkerMessage(reply)))
+        };
+    }
 
-        // Scheduling decision
-        let candidateTa = null;
-        if (requiresReschedule || !this.runningJob) {
-            candidateTa = this.selectMLLFTask();
-            let schedulingEvents = this.makeSchedulingDecision(candidateTa);
-            events.push(...schedulingEvents);
-        } else if (this.runningJob) {
-            this.updateAllLaxities();
-            events.push(`Continue J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
-        } else {
-            events.push('CPU Idle');
-            this.idleTime++;
-        }
+    // Every command carries the current run generation, which the worker echoes in its replies
+    postToWorker(msg) {
+        this.worker.postMessage({ ...msg, generation: this.generation });
+    }
 
-        // Record timeline
-        this.timeline.push({
-            time: this.currentTime,
-            runningJob: this.runningJob ? { ...this.runningJob } : null,
-            readyQueue: this.readyQueue.map(job => ({ ...job })),
-            events: [...events]
+    initializeEventListeners() {
+        document.getElementById('speedControl').addEventListener('change', (e) => {
+            this.speed = parseInt(e.target.value);
+            this.postToWorker({ type: 'speed', tickInterval: this.speed });
         });
+    }
 
-        // Execute running job
-        this.executeRunningJob();
+    addTask(arrival, period, wcet, deadline, aet) {
+        const task = {
+            id: this.tasks.length,
+            arrival,
+            period,
+            wcet,
+            deadline,
+            aet
+        };
+        this.tasks.push(task);
+        this.updateTasksDisplay();
+        return task;
+    }
 
-        // Check deadline misses
-        let misses = this.checkDeadlineMisses();
-        if (misses.length > 0) {
-            misses.forEach(job => {
-                events.push(`!!! DEADLINE MISS: J${job.jobId} deadline ${job.absoluteDeadline} at time ${this.currentTime + 1} !!!`);
-            });
-        }
+    removeTask(taskId) {
+        this.tasks = this.tasks.filter(task => task.id !== taskId);
+        this.tasks.forEach((task, index) => {
+            task.id = index;
+        });
+        this.updateTasksDisplay();
+    }
 
-        // Update displays
-        this.updateCurrentTimeDisplay();
-        this.updateStateDisplay();
-        this.updateStatisticsDisplay();
-        this.updateTimelineDisplay();
-        this.logEvents(events);
+    handleWorkerMessage(msg) {
+        if (msg.generation !== this.generation) return; // Late reply from a stopped or replaced run
+        if (msg.type === 'error') {
+            this.logMessage(msg.message, 'error');
+            return;
+        }
+        if (msg.type !== 'delta') return;
+
+        if (msg.title && this.store.length === 0) this.logMessage(`Loaded ${msg.title}`, 'info');
+        this.store.taskCount = Math.max(this.store.taskCount, msg.taskCount);
+        this.store.append(msg.start, msg.jobIds, msg.taskIds);
+        this.store.misses.push(...msg.misses);
+        this.currentTime = msg.time;
+        this.stats = msg.stats;
+        this.state = msg.state;
+        this.pendingLog.push(...msg.events);
+        if (this.pendingLog.length > LOG_LIMIT) this.pendingLog = this.pendingLog.slice(-LOG_LIMIT);
+        this.timelineView.dataAppended();
+        this.requestDisplayUpdate();
+
+        if (msg.done) this.stopSimulation();
+    }
 
-        this.currentTime++;
+    // Text displays are refreshed at most once per frame, however many deltas arrive
+    requestDisplayUpdate() {
+        if (this.displayUpdateRequested) return;
+        this.displayUpdateRequested = true;
+        requestAnimationFrame(() => {
+            this.displayUpdateRequested = false;
+            this.updateCurrentTimeDisplay();
+            this.updateStateDisplay();
+            this.updateStatisticsDisplay();
+            this.logEvents(this.pendingLog);
+            this.pendingLog = [];
+        });
     }
 
     startSimulation() {
@@ -383,76 +444,74 @@ class MLLFScheduler {
         }
 
         this.simulationTime = parseInt(document.getElementById('simTime').value);
-        this.generateJobs();
         this.resetSimulation();
+        this.store.taskCount = this.tasks.length;
+        this.timelineView.invalidate();
         this.isRunning = true;
-        
+
         document.getElementById('startBtn').disabled = true;
         document.getElementById('stepBtn').disabled = false;
-        
+
         this.logMessage('Simulation started', 'event');
-        
-        this.simulationInterval = setInterval(() => {
-            if (!this.isPaused) {
-                this.simulateStep();
-            }
-        }, this.speed);
+
+        this.postToWorker({ type: 'init', tasks: this.tasks, simulationTime: this.simulationTime });
+        this.postToWorker({ type: 'play', tickInterval: this.speed });
     }
 
     stopSimulation() {
+        if (!this.isRunning) return;
         this.isRunning = false;
-        if (this.simulationInterval) {
-            clearInterval(this.simulationInterval);
-        }
-        
+
         document.getElementById('startBtn').disabled = false;
         document.getElementById('stepBtn').disabled = true;
-        
+
         this.logMessage('Simulation completed', 'event');
     }
 
     resetSimulation() {
+        this.generation++;
+        this.postToWorker({ type: 'stop' });
         this.currentTime = 0;
-        this.readyQueue = [];
-        this.runningJob = null;
-        this.currentQuantum = 0;
-        this.contextSwitches = 0;
-        this.deadlineMisses = 0;
-        this.completedJobs = 0;
-        this.idleTime = 0;
-        this.lastRunningJobId = -1;
-        this.timeline = [];
-        
-        if (this.simulationInterval) {
-            clearInterval(this.simulationInterval);
-        }
+        this.stats = { contextSwitches: 0, deadlineMisses: 0, completedJobs: 0, idleTime: 0 };
+        this.state = { runningJob: null, readyQueue: [] };
+        this.pendingLog = [];
+        this.store.reset();
+        this.timelineView.follow = true;
+        this.timelineView.viewStart = 0;
+        this.timelineView.invalidate();
         this.isRunning = false;
-        this.isPaused = false;
-        
+
         document.getElementById('startBtn').disabled = false;
         document.getElementById('stepBtn').disabled = true;
-        
+
         this.updateCurrentTimeDisplay();
         this.updateStateDisplay();
         this.updateStatisticsDisplay();
-        this.updateTimelineDisplay();
         this.clearLog();
-        
+
         this.logMessage('Simulation reset', 'event');
     }
 
     stepSimulation() {
         if (this.currentTime < this.simulationTime) {
-            this.simulateStep();
+            this.postToWorker({ type: 'step' });
         } else {
             this.stopSimulation();
         }
     }
 
+    loadTraceFile(file) {
+        if (!file) return;
+        this.resetSimulation();
+        this.isRunning = true;
+        this.logMessage(`Loading trace ${file.name}...`, 'event');
+        this.postToWorker({ type: 'loadTrace', file });
+    }
+
     updateTasksDisplay() {
         const tasksList = document.getElementById('tasksList');
         tasksList.innerHTML = '';
-        
+
         this.tasks.forEach(task => {
             const taskDiv = document.createElement('div');
             taskDiv.className = 'task-item';
@@ -475,77 +534,42 @@ class MLLFScheduler {
     updateStateDisplay() {
         const runningJobElement = document.getElementById('runningJob');
         const readyQueueElement = document.getElementById('readyQueue');
-        
-        if (this.runningJob) {
-            runningJobElement.innerHTML = `J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`;
-        } else {
-            runningJobElement.textContent = 'None';
-        }
-        
-        if (this.readyQueue.length > 0) {
-            readyQueueElement.innerHTML = this.readyQueue
-                .map(job => `J${job.jobId}:${job.calculatedLaxity}`)
-                .join(', ');
-        } else {
-            readyQueueElement.textContent = 'Empty';
-        }
-    }
 
-    updateStatisticsDisplay() {
-        document.getElementById('contextSwitches').textContent = this.contextSwitches;
-        document.getElementById('deadlineMisses').textContent = this.deadlineMisses;
-        document.getElementById('completedJobs').textContent = this.completedJobs;
-        document.getElementById('idleTime').textContent = this.idleTime;
+        runningJobElement.textContent = this.state.runningJob || 'None';
+        readyQueueElement.textContent = this.state.readyQueue.length > 0 ? this.state.readyQueue.join(', ') : 'Empty';
     }
 
-    updateTimelineDisplay() {
-        const timelineElement = document.getElementById('timeline');
-        
-        if (this.timeline.length === 0) {
-            timelineElement.innerHTML = '<div style="text-align: center; color: #666; padding: 20px;">No simulation data yet</div>';
-            return;
-        }
-        
-        // Create timeline visualization
-        let html = '';
-        
-        // CPU timeline
-        html += '<div class="timeline-row">';
-        html += '<div class="timeline-label">CPU:</div>';
-        html += '<div class="timeline-bar">';
-        
-        for (let i = 0; i < this.timeline.length; i++) {
-            const entry = this.timeline[i];
-            const width = `${100 / this.timeline.length}%`;
-            
-            if (entry.runningJob) {
-                html += `<div class="timeline-segment running" style="width: ${width}" title="Time ${entry.time}: J${entry.runningJob.jobId}">J${entry.runningJob.jobId}</div>`;
-            } else {
-                html += `<div class="timeline-segment idle" style="width: ${width}" title="Time ${entry.time}: Idle">-</div>`;
-            }
-        }
-        
-        html += '</div></div>';
-        
-        timelineElement.innerHTML = html;
+    updateStatisticsDisplay() {
+        document.getElementById('contextSwitches').textContent = this.stats.contextSwitches;
+        document.getElementById('deadlineMisses').textContent = this.stats.deadlineMisses;
+        document.getElementById('completedJobs').textContent = this.stats.completedJobs;
+        document.getElementById('idleTime').textContent = this.stats.idleTime;
     }
 
     logEvents(events) {
+        const fragment = document.createDocumentFragment();
         events.forEach(event => {
-            if (event.includes('DEADLINE MISS')) {
-                this.logMessage(`Time ${this.currentTime}: ${event}`, 'error');
-            } else {
-                this.logMessage(`Time ${this.currentTime}: ${event}`, 'event');
-            }
+            const type = event.text.includes('DEADLINE MISS') ? 'error' : 'event';
+            fragment.appendChild(this.createLogEntry(`Time ${event.time}: ${event.text}`, type));
         });
+        this.appendLog(fragment);
     }
 
     logMessage(message, type = 'info') {
-        const logElement = document.getElementById('simulationLog');
+        this.appendLog(this.createLogEntry(message, type));
+    }
+
+    createLogEntry(message, type) {
         const logEntry = document.createElement('div');
         logEntry.className = `log-entry ${type}`;
         logEntry.textContent = message;
-        logElement.appendChild(logEntry);
+        return logEntry;
+    }
+
+    appendLog(node) {
+        const logElement = document.getElementById('simulationLog');
+        logElement.appendChild(node);
+        while (logElement.childElementCount > LOG_LIMIT) logElement.removeChild(logElement.firstChild);
         logElement.scrollTop = logElement.scrollHeight;
     }
 
@@ -563,19 +587,19 @@ function addTask() {
     const period = parseInt(document.getElementById('period').value);
     const wcet = parseInt(document.getElementById('wcet').value);
     const deadline = parseInt(document.getElementById('deadline').value);
-    const aet = parseInt(document.getElementById('aet').value);
-    
+    let aet = parseInt(document.getElementById('aet').value);
+
     if (wcet > deadline) {
         alert('Warning: WCET is greater than deadline. This task may not be schedulable.');
     }
-    
+
     if (aet > wcet) {
         alert('Warning: AET is greater than WCET. AET will be capped at WCET.');
         aet = wcet;
     }
-    
+
     scheduler.addTask(arrival, period, wcet, deadline, aet);
-    
+
     // Clear inputs
     document.getElementById('arrival').value = '0';
     document.getElementById('period').value = '10';
@@ -596,6 +620,20 @@ function stepSimulation() {
     scheduler.stepSimulation();
 }
 
+function loadTraceFile(input) {
+    scheduler.loadTraceFile(input.files[0]);
+    input.value = ''; // Allow loading the same file again
+}
+
+function zoomTimeline(factor) {
+    const view = scheduler.timelineView;
+    view.zoom(factor, view.viewStart + view.visibleTicks() / 2);
+}
+
+function fitTimeline() {
+    scheduler.timelineView.fit();
+}
+
 // Initialize with sample tasks
 document.addEventListener('DOMContentLoaded', function() {
     scheduler.addTask(0, 10, 3, 10, 2);
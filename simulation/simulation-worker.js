@@ -0,0 +1,595 @@
+// MLLF simulation engine and C trace parser. Runs as a Web Worker; index.html also loads it as a plain
+// script so script.js can fall back to running it on the page (e.g. when opened from file://).
+
+const LOG_TAIL_PER_BATCH = 200; // Events sent per batch; the log only shows the most recent ones anyway
+const MAX_SPEED_BATCH_TICKS = 2000;
+const TRACE_BATCH_TICKS = 50000;
+
+class MLLFEngine {
+    constructor(tasks, simulationTime) {
+        this.tasks = tasks;
+        this.simulationTime = simulationTime;
+        this.currentTime = 0;
+        this.readyQueue = [];
+        this.runningJob = null;
+        this.currentQuantum = 0;
+
+        // Statistics
+        this.contextSwitches = 0;
+        this.deadlineMisses = 0;
+        this.completedJobs = 0;
+        this.idleTime = 0;
+        this.lastRunningJobId = -1;
+
+        // Jobs are created when they arrive. Ids follow generation order (all jobs of task 0 first, ...),
+        // so the id of instance k is the task's first id plus k.
+        this.firstJobId = [];
+        this.nextInstance = [];
+        let jobId = 0;
+        for (let task of tasks) {
+            this.firstJobId.push(jobId);
+            this.nextInstance.push(0);
+            jobId += this.instanceCount(task);
+        }
+    }
+
+    instanceCount(task) {
+        return task.arrival < this.simulationTime ? Math.ceil((this.simulationTime - task.arrival) / task.period) : 0;
+    }
+
+    createJob(task, k) {
+        const arrivalTime = task.arrival + k * task.period;
+        return {
+            jobId: this.firstJobId[task.id] + k,
+            taskId: task.id,
+            instanceNumber: k,
+            arrivalTime: arrivalTime,
+            wcet: task.wcet,
+            aet: task.aet,
+            remainingAet: task.aet,
+            remainingWcet: task.wcet,
+            absoluteDeadline: arrivalTime + task.deadline,
+            calculatedLaxity: 0,
+            status: 'NOT_ARRIVED',
+            firstStartTime: -1,
+            lastStartTime: -1,
+            finishTime: -1
+        };
+    }
+
+    calculateLaxity(job) {
+        if (job.status === 'COMPLETED' || job.status === 'MISSED') {
+            return Infinity;
+        }
+        return job.absoluteDeadline - this.currentTime - job.remainingWcet;
+    }
+
+    updateAllLaxities() {
+        for (let job of this.readyQueue) {
+            job.calculatedLaxity = this.calculateLaxity(job);
+        }
+        if (this.runningJob) {
+            this.runningJob.calculatedLaxity = this.calculateLaxity(this.runningJob);
+        }
+    }
+
+    selectMLLFTask() {
+        if (this.readyQueue.length === 0 && !this.runningJob) {
+            return null;
+        }
+
+        this.updateAllLaxities();
+
+        let candidates = [...this.readyQueue];
+        if (this.runningJob && this.runningJob.status === 'RUNNING') {
+            candidates.push(this.runningJob);
+        }
+
+        if (candidates.length === 0) return null;
+
+        // Find minimum laxity
+        let minLaxity = Math.min(...candidates.map(job => job.calculatedLaxity));
+        let minLaxityJobs = candidates.filter(job => job.calculatedLaxity === minLaxity);
+
+        // Among jobs with minimum laxity, select the one with minimum remaining WCET
+        let minRemainingWcet = Math.min(...minLaxityJobs.map(job => job.remainingWcet));
+        let finalCandidates = minLaxityJobs.filter(job => job.remainingWcet === minRemainingWcet);
+
+        // Tie-break with job ID
+        return finalCandidates.reduce((min, job) =>
+            job.jobId < min.jobId ? job : min
+        );
+    }
+
+    calculateQuantum(taskTa) {
+        if (!taskTa || taskTa.remainingAet <= 0) {
+            return 0;
+        }
+
+        // Find earliest deadline among jobs with higher laxity
+        let earliestDeadline = Infinity;
+        let taLaxity = taskTa.calculatedLaxity;
+
+        let activeJobs = this.runningJob ? [...this.readyQueue, this.runningJob] : this.readyQueue;
+        for (let job of activeJobs) {
+            if (job === taskTa) continue;
+            let jobLaxity = this.calculateLaxity(job);
+            if (jobLaxity > taLaxity && job.absoluteDeadline < earliestDeadline) {
+                earliestDeadline = job.absoluteDeadline;
+            }
+        }
+
+        // Future instances of a task have increasing deadlines and laxities, so the first one
+        // whose laxity exceeds Ta's is the only candidate from that task
+        for (let task of this.tasks) {
+            const count = this.instanceCount(task);
+            for (let k = this.nextInstance[task.id]; k < count; k++) {
+                const deadline = task.arrival + k * task.period + task.deadline;
+                if (deadline >= earliestDeadline) break;
+                if (deadline - this.currentTime - task.wcet > taLaxity) {
+                    earliestDeadline = deadline;
+                    break;
+                }
+            }
+        }
+
+        if (earliestDeadline === Infinity || taskTa.absoluteDeadline <= earliestDeadline) {
+            // Run until completion
+            return taskTa.remainingAet;
+        } else {
+            // Quantum = Dmin - La
+            let quantum = earliestDeadline - taLaxity;
+            return Math.max(1, Math.min(quantum, taskTa.remainingAet));
+        }
+    }
+
+    handleArrivals() {
+        let arrivals = [];
+        for (let task of this.tasks) {
+            const k = this.nextInstance[task.id];
+            if (k < this.instanceCount(task) && task.arrival + k * task.period === this.currentTime) {
+                const job = this.createJob(task, k);
+                this.nextInstance[task.id]++;
+                job.status = 'READY';
+                this.readyQueue.push(job);
+                arrivals.push(job);
+            }
+        }
+        return arrivals.sort((a, b) => a.jobId - b.jobId);
+    }
+
+    handleCompletion() {
+        if (this.runningJob && this.runningJob.remainingAet <= 0 &&
+            this.runningJob.status !== 'COMPLETED' && this.runningJob.status !== 'MISSED') {
+
+            this.runningJob.status = 'COMPLETED';
+            this.runningJob.finishTime = this.currentTime;
+            this.completedJobs++;
+
+            let completedJob = this.runningJob;
+            this.runningJob = null;
+            this.currentQuantum = 0;
+
+            return completedJob;
+        }
+        return null;
+    }
+
+    makeSchedulingDecision(candidateTa) {
+        let events = [];
+        let contextSwitch = false;
+
+        if (!this.runningJob) {
+            // CPU Idle
+            if (candidateTa) {
+                this.runningJob = candidateTa;
+                this.runningJob.status = 'RUNNING';
+                this.readyQueue = this.readyQueue.filter(job => job !== candidateTa);
+                this.currentQuantum = this.calculateQuantum(this.runningJob);
+
+                if (this.runningJob.firstStartTime === -1) {
+                    this.runningJob.firstStartTime = this.currentTime;
+                }
+                this.runningJob.lastStartTime = this.currentTime;
+
+                events.push(`Start J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
+            } else {
+                events.push('CPU Idle');
+                this.idleTime++;
+            }
+        } else {
+            // CPU Busy
+            if (!candidateTa) {
+                events.push(`Continue J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
+            } else if (candidateTa !== this.runningJob) {
+                // Preemption
+                events.push(`Preempt J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity}) for J${candidateTa.jobId}(L${candidateTa.calculatedLaxity})`);
+
+                this.runningJob.status = 'READY';
+                this.readyQueue.push(this.runningJob);
+
+                this.runningJob = candidateTa;
+                this.runningJob.status = 'RUNNING';
+                this.readyQueue = this.readyQueue.filter(job => job !== candidateTa);
+                this.currentQuantum = this.calculateQuantum(this.runningJob);
+
+                if (this.runningJob.firstStartTime === -1) {
+                    this.runningJob.firstStartTime = this.currentTime;
+                }
+                this.runningJob.lastStartTime = this.currentTime;
+
+                contextSwitch = true;
+            } else {
+                // Continue or reset quantum
+                if (this.currentQuantum <= 0 && this.runningJob.remainingAet > 0) {
+                    this.currentQuantum = this.calculateQuantum(this.runningJob);
+                    events.push(`ResetQ J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
+                } else {
+                    events.push(`Continue J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
+                }
+            }
+        }
+
+        // Check for context switch
+        let currentRunningJobId = this.runningJob ? this.runningJob.jobId : -1;
+        if (currentRunningJobId !== this.lastRunningJobId &&
+            currentRunningJobId !== -1 && this.lastRunningJobId !== -1) {
+            this.contextSwitches++;
+            contextSwitch = true;
+        }
+        this.lastRunningJobId = currentRunningJobId;
+
+        if (contextSwitch) {
+            events.push('(CS)');
+        }
+
+        return events;
+    }
+
+    executeRunningJob() {
+        if (this.runningJob && this.runningJob.status === 'RUNNING') {
+            if (this.runningJob.remainingAet > 0) {
+                this.runningJob.remainingAet--;
+            }
+            if (this.runningJob.remainingWcet > 0) {
+                this.runningJob.remainingWcet--;
+            }
+            if (this.currentQuantum > 0) {
+                this.currentQuantum--;
+            }
+        }
+    }
+
+    checkDeadlineMisses() {
+        let misses = [];
+        let nextTime = this.currentTime + 1;
+
+        // Check running job
+        if (this.runningJob && this.runningJob.status === 'RUNNING') {
+            if (nextTime >= this.runningJob.absoluteDeadline && this.runningJob.remainingAet > 0) {
+                this.runningJob.status = 'MISSED';
+                this.deadlineMisses++;
+                misses.push(this.runningJob);
+                this.runningJob = null;
+                this.currentQuantum = 0;
+            }
+        }
+
+        // Check ready queue
+        for (let i = this.readyQueue.length - 1; i >= 0; i--) {
+            let job = this.readyQueue[i];
+            if (nextTime >= job.absoluteDeadline) { // Ready jobs always have work left
+                job.status = 'MISSED';
+                this.deadlineMisses++;
+                misses.push(job);
+                this.readyQueue.splice(i, 1);
+            }
+        }
+
+        return misses;
+    }
+
+    // Simulates one tick and returns what the timeline needs: who ran, the events and the misses
+    simulateStep() {
+        let events = [];
+        let requiresReschedule = false;
+
+        // Handle arrivals
+        let arrivals = this.handleArrivals();
+        if (arrivals.length > 0) {
+            arrivals.forEach(job => {
+                events.push(`Arrival J${job.jobId}(T${job.taskId})`);
+            });
+            requiresReschedule = true;
+        }
+
+        // Handle completion
+        let completed = this.handleCompletion();
+        if (completed) {
+            events.push(`Complete J${completed.jobId}`);
+            requiresReschedule = true;
+        }
+
+        // Check quantum expiration
+        if (this.runningJob && this.currentQuantum <= 0 && this.runningJob.remainingAet > 0) {
+            events.push(`Quantum Exp J${this.runningJob.jobId}`);
+            requiresReschedule = true;
+        }
+
+        // Scheduling decision
+        let candidateTa = null;
+        if (requiresReschedule || !this.runningJob) {
+            candidateTa = this.selectMLLFTask();
+            let schedulingEvents = this.makeSchedulingDecision(candidateTa);
+            events.push(...schedulingEvents);
+        } else if (this.runningJob) {
+            this.updateAllLaxities();
+            events.push(`Continue J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})`);
+        } else {
+            events.push('CPU Idle');
+            this.idleTime++;
+        }
+
+        const tick = {
+            time: this.currentTime,
+            runningJobId: this.runningJob ? this.runningJob.jobId : -1,
+            runningTaskId: this.runningJob ? this.runningJob.taskId : -1,
+            events: events,
+            misses: []
+        };
+
+        // Execute running job
+        this.executeRunningJob();
+
+        // Check deadline misses
+        let misses = this.checkDeadlineMisses();
+        misses.forEach(job => {
+            events.push(`!!! DEADLINE MISS: J${job.jobId} deadline ${job.absoluteDeadline} at time ${this.currentTime + 1} !!!`);
+            tick.misses.push({ time: this.currentTime + 1, jobId: job.jobId, taskId: job.taskId });
+        });
+
+        this.currentTime++;
+        return tick;
+    }
+
+    isFinished() {
+        return this.currentTime >= this.simulationTime;
+    }
+
+    statistics() {
+        return {
+            contextSwitches: this.contextSwitches,
+            deadlineMisses: this.deadlineMisses,
+            completedJobs: this.completedJobs,
+            idleTime: this.idleTime
+        };
+    }
+
+    stateSnapshot() {
+        return {
+            runningJob: this.runningJob ? `J${this.runningJob.jobId}(L${this.runningJob.calculatedLaxity},Q${this.currentQuantum})` : null,
+            readyQueue: this.readyQueue.map(job => `J${job.jobId}:${job.calculatedLaxity}`)
+        };
+    }
+}
+
+// Collects ticks into one delta message. Typed arrays are transferred, not copied.
+class DeltaBuilder {
+    constructor(start, capacity) {
+        this.start = start;
+        this.length = 0;
+        this.jobIds = new Int32Array(capacity);
+        this.taskIds = new Int32Array(capacity);
+        this.misses = [];
+        this.events = [];
+    }
+
+    add(time, jobId, taskId, events, misses) {
+        if (this.length === 0 && this.start < 0) this.start = time;
+        this.jobIds[this.length] = jobId;
+        this.taskIds[this.length] = taskId;
+        this.length++;
+        for (let event of events) this.events.push({ time, text: event });
+        if (this.events.length > 2 * LOG_TAIL_PER_BATCH) this.events = this.events.slice(-LOG_TAIL_PER_BATCH);
+        this.misses.push(...misses);
+    }
+
+    message(extra) {
+        const jobIds = this.jobIds.slice(0, this.length);
+        const taskIds = this.taskIds.slice(0, this.length);
+        return {
+            message: Object.assign({
+                type: 'delta',
+                start: this.start,
+                jobIds,
+                taskIds,
+                misses: this.misses,
+                events: this.events.slice(-LOG_TAIL_PER_BATCH)
+            }, extra),
+            transfer: [jobIds.buffer, taskIds.buffer]
+        };
+    }
+}
+
+// Parses the trace written by llf_scheduler.c. Only the first trace section is read (for partitioned
+// output that is core 0). Task ids come from the arrival events.
+class TraceParser {
+    constructor() {
+        this.state = 'HEADER'; // HEADER -> TICKS -> DONE
+        this.jobTask = new Map();
+        this.taskCount = 0;
+        this.lastTime = -1;
+        this.stats = { contextSwitches: 0, deadlineMisses: 0, completedJobs: 0, idleTime: 0 };
+        this.lastState = { runningJob: null, readyQueue: [] };
+        this.title = '';
+    }
+
+    // Returns true once the trace section has ended
+    parseLine(line, delta) {
+        if (this.state === 'DONE') return true;
+        if (this.state === 'HEADER') {
+            if (line.includes('Simulation Trace')) this.title = line.replace(/-/g, '').trim();
+            else if (this.title && line.startsWith('-----|')) this.state = 'TICKS';
+            return false;
+        }
+        if (line.startsWith('-----|')) {
+            this.state = 'DONE';
+            return true;
+        }
+
+        const miss = /DEADLINE MISS: J(\d+) deadline (\d+) at time (\d+)/.exec(line);
+        if (miss) {
+            const jobId = parseInt(miss[1]);
+            const taskId = this.jobTask.has(jobId) ? this.jobTask.get(jobId) : -1;
+            delta.misses.push({ time: parseInt(miss[3]), jobId, taskId });
+            delta.events.push({ time: parseInt(miss[3]) - 1, text: line.trim() });
+            this.stats.deadlineMisses++;
+            return false;
+        }
+
+        const tick = /^\s*(\d+) \| (.*?)\s*\|\s+(?:J(\d+)\s*\((L-?\d+,Q-?\d+)\)|Idle)\s*\|\s?(.*)$/.exec(line);
+        if (!tick) return false;
+        const time = parseInt(tick[1]);
+        const events = tick[2];
+        for (let arrival of events.matchAll(/Arrival J(\d+)\(T(\d+)\)/g)) {
+            const taskId = parseInt(arrival[2]);
+            this.jobTask.set(parseInt(arrival[1]), taskId);
+            if (taskId + 1 > this.taskCount) this.taskCount = taskId + 1;
+        }
+        const jobId = tick[3] !== undefined ? parseInt(tick[3]) : -1;
+        const taskId = jobId >= 0 && this.jobTask.has(jobId) ? this.jobTask.get(jobId) : -1;
+        if (events.includes('(CS)')) this.stats.contextSwitches++;
+        this.stats.completedJobs += (events.match(/Complete J/g) || []).length;
+        if (jobId < 0) this.stats.idleTime++;
+        this.lastState = {
+            runningJob: jobId >= 0 ? `J${jobId}(${tick[4]})` : null,
+            readyQueue: tick[5].trim().split(/\s+/).filter(entry => entry.length > 0)
+        };
+        delta.add(time, jobId, taskId, [events], []);
+        this.lastTime = time;
+        return false;
+    }
+}
+
+// --- Message handling (shared by the worker and the on-page fallback) ---
+let engine = null;
+let playTimer = null;
+let loadGeneration = 0; // Bumped by every command that replaces the current run, cancelling a trace load
+let playSettings = { tickInterval: 1000 };
+
+function postEngineDelta(post, builder) {
+    const { message, transfer } = builder.message({
+        stats: engine.statistics(),
+        state: engine.stateSnapshot(),
+        time: engine.currentTime,
+        taskCount: engine.tasks.length,
+        done: engine.isFinished()
+    });
+    post(message, transfer);
+}
+
+function runEngineTicks(post, count) {
+    const builder = new DeltaBuilder(engine.currentTime, count);
+    for (let i = 0; i < count && !engine.isFinished(); i++) {
+        const tick = engine.simulateStep();
+        builder.add(tick.time, tick.runningJobId, tick.runningTaskId, tick.events, tick.misses);
+    }
+    postEngineDelta(post, builder);
+}
+
+function playEngine(post) {
+    if (!engine || engine.isFinished()) return;
+    // Interval 0 = as fast as possible, in batches so the page receives a steady stream of deltas
+    const batch = playSettings.tickInterval > 0 ? 1 : MAX_SPEED_BATCH_TICKS;
+    runEngineTicks(post, batch);
+    if (!engine.isFinished()) playTimer = setTimeout(() => playEngine(post), playSettings.tickInterval);
+}
+
+function stopPlaying() {
+    if (playTimer !== null) clearTimeout(playTimer);
+    playTimer = null;
+}
+
+async function loadTrace(file, post) {
+    const generation = loadGeneration;
+    const parser = new TraceParser();
+    let builder = new DeltaBuilder(-1, TRACE_BATCH_TICKS);
+    const flush = (done) => {
+        if (builder.start < 0) builder.start = parser.lastTime + 1; // No ticks in this batch
+        const { message, transfer } = builder.message({
+            stats: parser.stats,
+            state: parser.lastState,
+            time: parser.lastTime + 1,
+            taskCount: parser.taskCount,
+            title: parser.title,
+            done
+        });
+        post(message, transfer);
+        builder = new DeltaBuilder(-1, TRACE_BATCH_TICKS);
+    };
+
+    const reader = file.stream().getReader();
+    const decoder = new TextDecoder();
+    let pending = '';
+    let finished = false;
+    while (!finished) {
+        const { value, done } = await reader.read();
+        if (generation !== loadGeneration) break;
+        pending += done ? decoder.decode() : decoder.decode(value, { stream: true });
+        const lines = pending.split('\n');
+        pending = done ? '' : lines.pop();
+        for (let line of lines) {
+            if (parser.parseLine(line, builder)) { finished = true; break; }
+            if (builder.length === TRACE_BATCH_TICKS) flush(false);
+        }
+        if (done) break;
+    }
+    reader.cancel().catch(() => {});
+    if (generation !== loadGeneration) return;
+    if (parser.title === '') {
+        post({ type: 'error', message: 'No simulation trace found in file.' });
+        return;
+    }
+    flush(true);
+}
+
+function handleWorkerMessage(msg, post) {
+    // Replies carry the generation of the command that caused them, so the page can drop those of an old run
+    const reply = (message, transfer) => {
+        message.generation = msg.generation;
+        post(message, transfer);
+    };
+    switch (msg.type) {
+        case 'init':
+            stopPlaying();
+            loadGeneration++;
+            engine = new MLLFEngine(msg.tasks, msg.simulationTime);
+            break;
+        case 'play':
+            stopPlaying();
+            playSettings.tickInterval = msg.tickInterval;
+            playEngine(reply);
+            break;
+        case 'speed':
+            playSettings.tickInterval = msg.tickInterval;
+            break;
+        case 'step':
+            if (engine && !engine.isFinished()) runEngineTicks(reply, 1);
+            break;
+        case 'stop':
+            stopPlaying();
+            loadGeneration++;
+            engine = null;
+            break;
+        case 'loadTrace':
+            stopPlaying();
+            loadGeneration++;
+            engine = null;
+            loadTrace(msg.file, reply).catch(error => reply({ type: 'error', message: `Could not read trace: ${error.message}` }));
+            break;
+    }
+}
+
+if (typeof WorkerGlobalScope !== 'undefined' && self instanceof WorkerGlobalScope) {
+    self.onmessage = (e) => handleWorkerMessage(e.data, (message, transfer) => self.postMessage(message, transfer || []));
+}